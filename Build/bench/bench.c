@@ -0,0 +1,63 @@
+// Benchmark support
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <avr/sleep.h>
+#include <stdlib.h>
+#include "clock.h"
+#include "bench.h"
+
+static void Bench_Text (const char * pText)
+{
+	while (*pText)
+		GPIOR0 = *pText++;
+}
+
+static void Bench_Text_P (const char * pText)
+{
+	char c;
+
+	while ((c = pgm_read_byte(pText++)))
+		GPIOR0 = c;
+}
+
+void Bench_Init (void)
+{
+	Clock_Init(BENCH_HZ, Clock_Div_1, 0);
+}
+
+void Bench_Begin (const char * pName, unsigned int uiCalls)
+{
+	char acCalls [6];
+
+	Bench_Text_P(PSTR("name="));
+	Bench_Text_P(pName);
+	Bench_Text_P(PSTR(" calls="));
+	Bench_Text(utoa(uiCalls, acCalls, 10));
+	GPIOR1 = BENCH_RUN;
+}
+
+void Bench_Pause (void)
+{
+	GPIOR1 = BENCH_PAUSE;
+}
+
+void Bench_Resume (void)
+{
+	GPIOR1 = BENCH_RUN;
+}
+
+void Bench_End (void)
+{
+	GPIOR1 = BENCH_END;
+}
+
+void Bench_Done (void)
+{
+	cli();
+	set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+	sleep_enable();
+	for (;;)
+		sleep_cpu();
+}
@@ -0,0 +1,43 @@
+// Benchmark support, ATmega328P under simavr
+// Revision History:
+// Oct 2026 - Initial Build, cycle counts of library calls, counted by the
+//             simavr runner (Tools/simbench.c)
+// Oct 2026 - Pull-ups on PC0 / PC1 for a software I2C bus
+
+// a benchmark firmware makes a library call a number of times between
+//  Bench_Begin and Bench_End, and the runner counts the CPU cycles in
+//  between from the simulator, so nothing on the target does the timing
+//  (the loop around the calls is counted with them)
+// the firmware talks to the runner through general purpose I/O registers
+//  nothing else uses:
+//   GPIOR0  text, a byte at a time (the "name=... calls=..." of a run)
+//   GPIOR1  BENCH_RUN counts cycles, BENCH_PAUSE stops counting for set-up
+//            that isn't part of the call, BENCH_END prints the run
+// Bench_Done stops the CPU (sleep with interrupts off), which ends the run
+// the runner has an I2C slave on the TWI at every address that ACKs every
+//  byte and reads 0x00 (an LCD that is never busy), so the drivers run
+//  their whole paths, at the bus rate's own byte times
+// PC0 and PC1 are pulled up, for a software bus (I2C_SoftInit), with no
+//  slave on it
+
+#define BENCH_HZ 16000000UL   // the runner's CPU clock, a 16MHz crystal
+
+#define BENCH_END 0
+#define BENCH_RUN 1
+#define BENCH_PAUSE 2
+
+// clock service at BENCH_HZ, call first
+void Bench_Init (void);
+
+// start counting a run of uiCalls calls, pName (PROGMEM) has no spaces
+void Bench_Begin (const char * pName, unsigned int uiCalls);
+
+// stop counting for set-up between calls, and go on
+void Bench_Pause (void);
+void Bench_Resume (void);
+
+// end the run, the runner prints its line
+void Bench_End (void);
+
+// end the firmware, doesn't return
+void Bench_Done (void);
@@ -0,0 +1,121 @@
+// I2C benchmark, TWI and software bus write streams
+// cycles per byte of a 32 byte write (the START and address of each
+//  stream counted in), at both bus rates on the TWI and on a software bus,
+//  a whole I2C_Transact of a single byte (an expander / LCD port write),
+//  and the two lanes at once: the TWI from its interrupt (I2C_WriteAsync)
+//  while the software bus goes in the foreground, per byte of both
+// 16MHz / per_call is bytes a second, a software bus byte is nine bits, so
+//  its SCL rate is 9 * 16MHz / per_call less the START's share
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include "clock.h"
+#include "I2C.h"
+#include "bench.h"
+
+#define BENCH_ADDR 0x27       // anything, the runner's slave ACKs all of them
+#define BENCH_STREAM 32       // bytes a stream
+#define BENCH_STREAMS 16
+
+// the software bus, the runner pulls PC0 / PC1 up but has no slave on
+//  them, so every byte is NACKed (all nine bits clocked all the same) and
+//  each stream starts with a repeated START
+#define BENCH_SDA PORTC0
+#define BENCH_SCL PORTC1
+
+static I2C_Bus _SoftBus;
+
+static int Bench_ByteXfer (I2C_Bus * pBus, unsigned char uc7Addr, void * pCtx)
+{
+	int iRet = I2C_BusStart(pBus, uc7Addr, I2C_WRITE);
+
+	if (iRet)
+		return iRet;
+
+	return I2C_BusWrite8(pBus, *(unsigned char *)pCtx, I2C_STOP);
+}
+
+static void Bench_Streams (void)
+{
+	for (unsigned char i = 0; i < BENCH_STREAMS; ++i)
+	{
+		(void)I2C_Start(BENCH_ADDR, I2C_WRITE);
+		for (unsigned char j = 0; j < BENCH_STREAM; ++j)
+			(void)I2C_Write8(j, j == BENCH_STREAM - 1);
+	}
+}
+
+static void Bench_SoftStream (void)
+{
+	(void)I2C_BusStart(&_SoftBus, BENCH_ADDR, I2C_WRITE);
+	for (unsigned char j = 0; j < BENCH_STREAM; ++j)
+		(void)I2C_BusWrite8(&_SoftBus, j, j == BENCH_STREAM - 1);
+}
+
+// the TWI lane's bytes, from its interrupt
+static unsigned char Bench_Next (void)
+{
+	return 0x5A;
+}
+
+int main (void)
+{
+	unsigned char ucHealth = 0;
+	unsigned char ucByte = 0x5A;
+
+	Bench_Init();
+
+	(void)I2C_Init(Clock_Hz(), I2CBus100);
+	Bench_Begin(PSTR("I2C_Write8@100k"), BENCH_STREAMS * BENCH_STREAM);
+	Bench_Streams();
+	Bench_End();
+
+	(void)I2C_Init(Clock_Hz(), I2CBus400);
+	Bench_Begin(PSTR("I2C_Write8@400k"), BENCH_STREAMS * BENCH_STREAM);
+	Bench_Streams();
+	Bench_End();
+
+	Bench_Begin(PSTR("I2C_Transact@400k"), BENCH_STREAMS);
+	for (unsigned char i = 0; i < BENCH_STREAMS; ++i)
+		(void)I2C_Transact(I2C_HW, BENCH_ADDR, &ucHealth, Bench_ByteXfer, &ucByte);
+	Bench_End();
+
+	(void)I2C_SoftInit(&_SoftBus, &PORTC, BENCH_SDA, BENCH_SCL, Clock_Hz(), I2CBus100);
+	Bench_Begin(PSTR("I2C_BusWrite8/soft@100k"), BENCH_STREAMS * BENCH_STREAM);
+	for (unsigned char i = 0; i < BENCH_STREAMS; ++i)
+		Bench_SoftStream();
+	Bench_End();
+
+	(void)I2C_SoftInit(&_SoftBus, &PORTC, BENCH_SDA, BENCH_SCL, Clock_Hz(), I2CBus400);
+	Bench_Begin(PSTR("I2C_BusWrite8/soft@400k"), BENCH_STREAMS * BENCH_STREAM);
+	for (unsigned char i = 0; i < BENCH_STREAMS; ++i)
+		Bench_SoftStream();
+	Bench_End();
+
+	// the TWI interrupt from here on
+	sei();
+	Bench_Begin(PSTR("I2C_WriteAsync@400k"), BENCH_STREAMS * BENCH_STREAM);
+	for (unsigned char i = 0; i < BENCH_STREAMS; ++i)
+	{
+		(void)I2C_Start(BENCH_ADDR, I2C_WRITE); // waits for the last one
+		(void)I2C_WriteAsync(Bench_Next, BENCH_STREAM);
+	}
+	while (I2C_Busy())
+		;
+	Bench_End();
+
+	Bench_Begin(PSTR("I2C_WriteAsync+soft@400k"), 2 * BENCH_STREAMS * BENCH_STREAM);
+	for (unsigned char i = 0; i < BENCH_STREAMS; ++i)
+	{
+		(void)I2C_Start(BENCH_ADDR, I2C_WRITE);
+		(void)I2C_WriteAsync(Bench_Next, BENCH_STREAM);
+		Bench_SoftStream();
+	}
+	while (I2C_Busy())
+		;
+	Bench_End();
+
+	Bench_Done();
+	return 0;
+}
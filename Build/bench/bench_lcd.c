@@ -0,0 +1,37 @@
+// LCD benchmark, PCF8574A backpack on the TWI at 100kHz
+// cycles per call of a full row string, a counted run and an address set
+
+#include <avr/pgmspace.h>
+#include "clock.h"
+#include "I2C.h"
+#include "PCF8574A.h"
+#include "bench.h"
+
+#define BENCH_CALLS 32
+
+int main (void)
+{
+	char acRow [] = "0123456789ABCDEF";
+
+	Bench_Init();
+	(void)I2C_Init(Clock_Hz(), I2CBus100);
+	(void)LCD_Init(Clock_Hz());
+
+	Bench_Begin(PSTR("LCD_StringXY/16"), BENCH_CALLS);
+	for (unsigned char i = 0; i < BENCH_CALLS; ++i)
+		(void)LCD_StringXY(0, i & 1, acRow);
+	Bench_End();
+
+	Bench_Begin(PSTR("LCD_Chars/4"), BENCH_CALLS);
+	for (unsigned char i = 0; i < BENCH_CALLS; ++i)
+		(void)LCD_Chars(acRow + (i & 3), 4);
+	Bench_End();
+
+	Bench_Begin(PSTR("LCD_AddrXY"), BENCH_CALLS);
+	for (unsigned char i = 0; i < BENCH_CALLS; ++i)
+		(void)LCD_AddrXY(i & 15, i >> 4 & 1);
+	Bench_End();
+
+	Bench_Done();
+	return 0;
+}
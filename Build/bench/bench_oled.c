@@ -0,0 +1,49 @@
+// OLED benchmark, the built-in 128 x 32 SSD1306 on the TWI at 400kHz
+// cycles per call of line drawing (back-buffer only) and of renders of a
+//  whole frame and of one changed character cell
+
+#include <avr/pgmspace.h>
+#include "clock.h"
+#include "I2C.h"
+#include "SSD1306.h"
+#include "bench.h"
+
+#define BENCH_LINES 64
+#define BENCH_FRAMES 8
+#define BENCH_CELLS 32
+
+int main (void)
+{
+	Bench_Init();
+	(void)I2C_Init(Clock_Hz(), I2CBus400);
+	(void)SSD1306_DispInit(SSD1306_OR_UP);
+
+	// corner to corner and back, every slope in between
+	Bench_Begin(PSTR("SSD1306_Line"), BENCH_LINES);
+	for (unsigned char i = 0; i < BENCH_LINES; ++i)
+		SSD1306_Line(0, i & 31, 127, 31 - (i & 31));
+	Bench_End();
+
+	Bench_Begin(PSTR("SSD1306_Render/frame"), BENCH_FRAMES);
+	for (unsigned char i = 0; i < BENCH_FRAMES; ++i)
+	{
+		Bench_Pause();
+		SSD1306_FillRect(0, 0, 128, 32, SSD1306_BLIT_XOR);
+		Bench_Resume();
+		(void)SSD1306_Render();
+	}
+	Bench_End();
+
+	Bench_Begin(PSTR("SSD1306_Render/cell"), BENCH_CELLS);
+	for (unsigned char i = 0; i < BENCH_CELLS; ++i)
+	{
+		Bench_Pause();
+		SSD1306_CharXY(i & 15, 1, '0' + (i >> 4)); // a new character every time
+		Bench_Resume();
+		(void)SSD1306_Render();
+	}
+	Bench_End();
+
+	Bench_Done();
+	return 0;
+}
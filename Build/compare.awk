@@ -0,0 +1,65 @@
+# compare two make report outputs, the baseline first and then the new one
+# Revision History:
+# Oct 2026 - Initial Build, flash / RAM per image and cycles per call per
+#             benchmark run, old -> new and the change
+#
+# awk -f compare.awk baseline.txt out/report.txt (make compare does this)
+# a line per figure: <what> <key> <old> -> <new> <change %>, a figure only
+#  one side has is marked new / gone, an image that didn't run to its end
+#  (done status other than ok) fails the compare
+
+# the key=value fields of a report line into kv[]
+function fields(    i, n, a)
+{
+	delete kv
+	for (i = 2; i <= NF; ++i)
+	{
+		n = index($i, "=")
+		if (n)
+			kv[substr($i, 1, n - 1)] = substr($i, n + 1)
+	}
+}
+
+# what a line measures, by the kind of line
+function record(side,    k)
+{
+	fields()
+	if ($1 == "size")
+	{
+		k = kv["variant"] "/" kv["image"]
+		val[side, "flash " k] = kv["flash"]
+		val[side, "ram " k] = kv["ram"]
+		keys["flash " k]; keys["ram " k]
+	}
+	else if ($1 == "bench")
+	{
+		k = "cycles " kv["tag"] " " kv["name"]
+		val[side, k] = kv["per_call"]
+		keys[k]
+	}
+	else if ($1 == "done" && side == "new" && kv["status"] != "ok")
+	{
+		print "failed " kv["tag"] " " kv["status"]
+		bad = 1
+	}
+}
+
+FNR == 1 { ++file }
+file == 1 { record("old"); next }
+{ record("new") }
+
+END {
+	for (k in keys)
+	{
+		if (!(("old", k) in val))
+			printf "%s new %s\n", k, val["new", k]
+		else if (!(("new", k) in val))
+			printf "%s gone %s\n", k, val["old", k]
+		else if (val["old", k] == 0)
+			printf "%s %s -> %s\n", k, val["old", k], val["new", k]
+		else
+			printf "%s %s -> %s %+.1f%%\n", k, val["old", k], val["new", k], \
+				100 * (val["new", k] - val["old", k]) / val["old", k]
+	}
+	exit bad
+}
@@ -1,7 +1,7 @@
 /********************************************************************/
 // Program:  Stopwatch
 // Processor:     Atmega328p
-// Bus Speed:     8 MHz
+// Bus Speed:     16 MHz (8 MHz internal RC with the watch crystal), 1 MHz when idle
 // Author:        Sharry SIngh
 // Details:       making stopwatch with atmega328p using various concept
 // Date:          Sept 28, 2023
@@ -11,15 +11,29 @@
 // Library includes
 /********************************************************************/
 // your includes go here
-#define F_CPU 8E6 // with external xtal enabled, and clock div/8, bus == 2MHz
 #include <avr/io.h>
-#include <util/delay.h>
+#include "clock.h"
 #include "I2C.h"
 #include "PCF8574A.h"
 #include "timer.h"
+#include "pwm.h"
+#include "power.h"
+#include "prof.h"
+#include "button.h"
+#include "eelog.h"
+#include "uart.h"
+#include "telem.h"
+#include "sched.h"
+#include "mem.h"
+#include "SSD1306.h"
+#include "console.h"
+#include "expander.h"
+#include "keypad.h"
 #include <avr/sleep.h>
 #include <avr/interrupt.h>
+#include <avr/pgmspace.h>
 #include <stdio.h>
+#include <string.h>
 
 
 /********************************************************************/
@@ -27,41 +41,220 @@
 /********************************************************************/
 #define  BUTTON1 PB1//button switch connected to port B pin1
 #define  BUTTON2 PB2//button switch connected to port B pin2
+#define  BUTTON_ICP PB0//start/stop button on ICP1, stamped by timer input capture
+#define  BUTTON_LEFT (1 << BUTTON1)//button event masks
+#define  BUTTON_RIGHT (1 << BUTTON2)
+#if defined(_SSD1306_SPI) && BUTTON2 == PB2
+#error "the SSD1306 SPI transport drives SS (PB2) as an output, move BUTTON2 off PB2"
+#endif
 
+#define  CAPTURE_LOCKOUT_US 50000//ignore capture edges this soon after the last one (contact bounce)
 
-//To model switch states
-typedef enum SwState
+// TIME_CS: hh:mm:ss.cc, redrawn at 20 Hz while running, otherwise hh:mm:ss at 10 Hz
+#define  TIME_CS
+#ifdef TIME_CS
+#define  TICKS_PER_UPDATE 5//10ms service ticks between display frames while running (20 Hz)
+#else
+#define  TICKS_PER_UPDATE 10//(10 Hz)
+#endif
+
+// a display frame writes at most what fits in FRAME_BUDGET_US, at the recent worst time
+//  per character (FRAME_CHAR_US to start with, an eighth off each run so one slow run,
+//  a retry or a resync, doesn't hold the frame back for good), the rest is left for the
+//  render task's next run, so the input and timekeeping tasks get a turn in between
+#define  FRAME_BUDGET_US 25000//half a 20 Hz frame
+#define  FRAME_CHAR_US 5000//one character on both displays, 100kHz I2C, with the window set up
+
+#define  REDRAW_TIME 0b00000001//LCD parts to redraw
+#define  REDRAW_STATE 0b00000010
+#define  REDRAW_LAP 0b00000100//running, last lap over the state line
+
+#define  LAP_MAX 255//laps numbered in a run, the rest are all 255 and show no lap time
+
+// the time, after the label on the LCD top line, only the characters that changed
+//  since the last redraw are written
+#ifdef TIME_CS
+#define  TIME_LAYOUT "00:00:00.00"
+#define  TIME_LABEL "Time "
+#define  TIME_UNIT_CS 1//redraw when the centiseconds change
+#else
+#define  TIME_LAYOUT "00:00:00"
+#define  TIME_LABEL "Time : "
+#define  TIME_UNIT_CS 100//redraw when the seconds change
+#endif
+#define  TIME_CHARS (sizeof(TIME_LAYOUT) - 1)
+#define  TIME_LCD_X (sizeof(TIME_LABEL) - 1)
+
+// OLED_MIRROR: time (large digits) and state mirrored on the SSD1306 (128x32 at 0x3C,
+//  same I2C bus), changed digits only, each run of them pushed as one column window
+#define  OLED_MIRROR
+#define  OLED_FONT SSD1306_FontNum24//24 px digits, banks 0-2 (hh:mm:ss.cc is 125 px)
+#define  OLED_STATE_BANK 3//state text under the digits
+
+// LCD_SOFT_I2C: the LCD on its own bit-banged I2C bus (I2C.h), SDA on PC0 and SCL on PC1
+//  with 4.7k pull-ups, so LCD writes don't queue behind OLED frames on the TWI
+//#define  LCD_SOFT_I2C
+// I2C_BENCH: at power up, time whole OLED frames on the TWI, whole LCD redraws on the LCD's
+//  bus and both together, one TELEM_BUS frame each. Build the libraries with
+//  _SSD1306_I2C_ASYNC for the OLED frames to go out from the TWI interrupt alongside the
+//  software bus, otherwise "both" is one after the other
+//#define  I2C_BENCH
+#define  I2C_BENCH_PASSES 8//frames / redraws in each run
+
+// KEYPAD: a 4x4 matrix keypad (keypad.h) on a PCF8574 at EXPANDER_ADDR on the LCD's bus, its
+//  INT on INT0 (PD2), read only when a key changes. '*' and '#' are the left and right
+//  buttons, 'A' is the left button held (review)
+//#define  KEYPAD
+#define  KEY_LEFT '*'
+#define  KEY_RIGHT '#'
+#define  KEY_HOLD 'A'
+
+#ifdef LCD_SOFT_I2C
+#define  LCD_BUS (&_lcdBus)
+#else
+#define  LCD_BUS I2C_HW
+#endif
+#if defined(I2C_BENCH) && !defined(OLED_MIRROR)
+#error I2C_BENCH times the OLED, it needs OLED_MIRROR
+#endif
+
+// 1 Hz run LED
+// LED_HW_1HZ: square wave from timer 2 on OC2B (PD3), clocked by a 32.768kHz watch
+//  crystal on TOSC1/TOSC2, no CPU time at all. Those are the XTAL pins, so the CPU
+//  has to run from the internal 8MHz RC (CKSEL fuses) and the LED moves to PD3
+// otherwise the LED stays on PD7 (not an OC pin, and neither 8-bit timer gets down
+//  to 1 Hz from the CPU clock) and is toggled from the service tick ISR
+//#define  LED_HW_1HZ
+#define  LED_HALF_TICKS 50//10ms service ticks per LED half period
+
+// POWER_TICKLESS: power-save while not running (IDLE / STOP / RESET), timer 2 on the same
+//  watch crystal keeps the time and wakes us only for the next software timer, a button
+//  wakes us by pin change
+//#define  POWER_TICKLESS
+// POWER_BENCH: line 2 of the LCD shows wake-ups per hour (from power.h) every minute
+//  instead of the state, power-save or the tickless idle of the default build
+//#define  POWER_BENCH
+#define  BENCH_TICKS 6000//10ms service ticks between benchmark updates
+
+// telemetry (telem.h) on USART0 TXD/RXD (PD1/PD0), always on, Tools/telemdump.c decodes it
+#define  TELEM_BAUD 38400//0.2% out at 8 and 16MHz, out of reach at 1MHz (off while slow)
+#define  TELEM_TICKS 1000//10ms service ticks between counter frames
+
+// profiling probes (prof.h, build with _PROF defined), right button in IDLE shows them
+enum ProfProbes
 {
-	Idle,
-	Pressed,
-	Held,
-	Released,
-}SwState;
-// enum to describe mc switch positions
-// tag values represent actual bit positions
-typedef enum SwitchPos
+	PROF_UPDATE_LCD,//whole LCD refresh
+	PROF_LCD_STRING,//time line writes (changed characters, both displays)
+	PROF_FOLD//stopwatch fold
+};
+
+#if defined(LED_HW_1HZ) || defined(POWER_TICKLESS)
+#define  WATCH_CRYSTAL//32.768kHz crystal on TOSC1/TOSC2, CPU on the internal RC
+#endif
+
+// CPU clock (clock.h), fast while running or drawing, slow while waiting for a button
+// Timer1 runs at /64 from the fast clock, the RC's 1MHz keeps its 125kHz at /8, the
+//  crystal's changes it (Timer_Micros is rebased, the service tick scaled)
+#ifdef WATCH_CRYSTAL
+#define  CLOCK_SOURCE 8000000UL//internal RC
+#define  CLOCK_FAST Clock_Div_1//8MHz
+#define  CLOCK_SLOW Clock_Div_8//1MHz
+#else
+#define  CLOCK_SOURCE 16000000UL//external crystal
+#define  CLOCK_FAST Clock_Div_1//16MHz
+#define  CLOCK_SLOW Clock_Div_16//1MHz
+#endif
+#define  SERVICE_TICK_HZ 100//10ms service tick
+#define  CLOCK_QUIET_TICKS 10//service ticks without a frame before the slow clock, a burst of frames stays fast
+
+// scheduler (sched.h) tasks, in priority order, and the events that release them
+enum Tasks
 {
-	SWL_RIGHT= BUTTON2,
-	SWL_LEFT = BUTTON1
-} SWL_SwitchPos;
+	TASK_INPUT,//buttons, ICP1 stamps and host requests, on their ISRs
+	TASK_FOLD,//timekeeping while running, every display frame
+	TASK_RENDER,//display frame, when something needs redrawing
+	TASK_TELEM,//telemetry counters
+#ifdef POWER_BENCH
+	TASK_BENCH,//power benchmark line
+#endif
+	TASK_COUNT
+};
+#define  TASK_EV_INPUT 0b00000001//button event or capture queued, pin change wake
+#define  TASK_EV_HOST 0b00000010//byte from the host
+#define  TASK_EV_REDRAW 0b00000100//_redraw set
+#define  INPUT_DEADLINE_TICKS 2//10ms service ticks from an input to having acted on it
+
 
 enum States  //enum for stopwatch states
 {
 	IDLE,
 	RUN,
 	STOP,
-	RESET
+	RESET,
+	REVIEW,//paging through the stored laps
+	STATE_COUNT
 };
 
+enum Events  //enum for stopwatch inputs
+{
+	EV_LEFT,//left button pressed and released
+	EV_RIGHT,//right button pressed
+	EV_ICP,//ICP1 button edge, stamped
+	EV_HOLD,//left button held (long press, then repeats)
+	EV_COUNT
+};
+
+// one state machine transition, action gets the time of the event
+typedef struct Transition
+{
+	void (*action)(unsigned long);//run on the event, or 0
+	unsigned char next;//state after the event
+} Transition;
+
 /********************************************************************/
 // Local Prototypes
 /********************************************************************/
 void UpdateLCD();//function to update LCD
-void sw_Run();//function when state is run
-void sw_Stop();//function when state is stop
-void sw_Reset();//function hen state is reset
-SwState Sw_Process(SwState*, SWL_SwitchPos);
-int SWL_Pushed (SWL_SwitchPos);
+void sw_Dispatch(unsigned char, unsigned long);//function to run an event through the state table
+void sw_Tick();//function to fold the running time and ask for a redraw when it shows
+void sw_Reset(unsigned long);//function to clear the stopwatch
+void sw_Start(unsigned long);//function to enter run state
+void sw_Pause(unsigned long);//function to leave run state
+void sw_Profile(unsigned long);//function to show the profiling probes
+void sw_Lap(unsigned long);//function to record a lap
+void sw_Review(unsigned long);//function to enter review on the newest lap
+void sw_ReviewNext(unsigned long);//function to page to the next older lap
+void sw_ReviewEnd(unsigned long);//function to leave review
+void review_Show();//function to show the lap under review
+void state_Show(FILE *);//function to print the state name on a console
+void sw_PrintCs(FILE *, unsigned long);//function to print centiseconds as hh:mm:ss.cc
+unsigned char time_Show(const char *, unsigned long);//function to write the changed time characters to the displays
+void time_Invalidate();//function to have the whole time line written next redraw
+void oled_Init();//function to bring up the mirror OLED and lay out the digit cells
+void sw_Fold(unsigned long);//function to add time since last fold to the stopwatch
+void task_Input();//function to take the inputs (scheduler task)
+void task_Fold();//function to fold the running time (scheduler task)
+void task_Render();//function to draw a display frame (scheduler task)
+void task_Telem();//function to send the telemetry counters (scheduler task)
+void task_PostInput();//function to release the input task, from an ISR
+void task_PostHost();//function to release the input task for a host byte, from an ISR
+void sw_Capture();//function to handle ICP1 start/stop stamps
+void sw_Buttons();//function to handle button presses
+void sw_Keys();//function to handle keypad presses
+void led_Start();//function to start the 1 Hz LED
+void led_Stop();//function to stop the 1 Hz LED, leaving it off
+void led_Toggle();//service tick callback for the software LED
+void sw_CaptureMissed();//function to start on an ICP1 press that came in power-save
+void power_Bench();//function to show wake-ups per hour
+void prof_Show(unsigned char, const char *);//function to show a profiling line on the LCD
+void telem_Counters();//function to send the counters frames
+int telem_Mem();//function to send the SRAM frame
+void telem_Tasks();//function to send a frame per scheduler task
+unsigned char * telem_U16(unsigned char *, unsigned int);//function to put a u16 into a telemetry payload
+unsigned char * telem_U32(unsigned char *, unsigned long);//function to put a u32 into a telemetry payload
+void i2c_Bench();//function to time the I2C lanes
+void clock_Pace(Clock_Div);//function to change the CPU clock
+void clock_Changed(unsigned long);//function to move the rest of the app to a new CPU clock
 
 void init_portB()
 {
@@ -71,10 +264,12 @@ void init_portB()
 	// Set PB1 and PB2 as input pins
 	DDRB &= ~(1 << BUTTON1);
 	DDRB &= ~(1 << BUTTON2);
+	DDRB &= ~(1 << BUTTON_ICP);
 
 	// Enable pull-up resistors on PB1 and PB2
 	PORTB |= (1 << BUTTON1);
 	PORTB |= (1 << BUTTON2);
+	PORTB |= (1 << BUTTON_ICP);
 }
 
 
@@ -82,51 +277,168 @@ void init_portB()
 // Global Variables
 /********************************************************************/
 
-const unsigned int _Timer_OC_Offset = 12500;// constant for timer output compare offset, init and ISR rearm
+// software timers on the 10ms service tick
+Timer_Soft _tLed;//software 1 Hz LED
+
+unsigned char _wokePin = 0;//power-save ended by a pin change, the ICP1 edge may have been lost
+unsigned char _memAlarm = 0;//the stack has come within MEM_ALARM_BYTES of .bss, reported
+
+// stopwatch time, folded from Timer_Micros while running
+unsigned long _elapsedCs = 0;//whole centiseconds
+unsigned long _elapsedUs = 0;//part of a centisecond not yet counted
+unsigned long _lastUs = 0;//Timer_Micros at the last fold
+unsigned long _lastCaptureUs = 0;//stamp of the last accepted ICP1 edge
 
-// global isr-modified 100ms tick counter
-volatile unsigned long _Update=0;
-volatile unsigned long _secondCounter=0;
+// laps, each split is queued to the EEPROM log (eelog.h) as it is taken
+unsigned char _lap = 0;//laps in this run, also the log record tag
+unsigned long _lastSplitCs = 0;//stopwatch time at the last lap
+unsigned long _lastLapCs = 0;//length of the last lap
+unsigned int _reviewAge = 0;//lap under review, 0 is the newest
+unsigned long _leftUs = 0;//Timer_Micros of the left press
+unsigned char _leftHeld = 0;//left button went to a long press, no EV_LEFT on release
 
-// global isr-modfied  tick counts
+// display fields, derived from _elapsedCs
 unsigned int _seconds=00, _minutes = 00, _hours =00;
 
 enum States _state= IDLE;//current state of STOPWATCH
+unsigned char _redraw = 0;//REDRAW_ parts of the LCD that are out of date
+char _shownTime[TIME_CHARS + 1] = {0};//time on the displays now, 0 where it has to be written
+#ifdef OLED_MIRROR
+unsigned char _oledX[TIME_CHARS];//OLED pixel column of each time character
+#endif
+
+#ifdef LCD_SOFT_I2C
+I2C_Bus _lcdBus;//the LCD's own software bus
+#endif
+
+// text consoles (console.h), printed to straight into the display shadows
+Console _lcdConsole;
+FILE * _lcd;//LCD, both lines
+#ifdef OLED_MIRROR
+Console _oledConsole;
+FILE * _oled;//OLED 5x7 text grid, the state under the digits
+#endif
+
+Clock_Div _clockDiv = CLOCK_FAST;//CPU clock divider now
+unsigned long _fastTick = 0;//Timer_TickCount of the last call for the fast clock
+Timer_Soft _tQuiet;//wakes us CLOCK_QUIET_TICKS after that, to slow down
+
+// display frames, for diagnostics (telemetry)
+unsigned long _frames = 0;//UpdateLCD passes
+unsigned int _frameOverruns = 0;//frames over budget (late frames are the render task's deadline misses)
+unsigned int _frameDeferred = 0;//frames that left characters for the next pass
+unsigned long _frameWorstUs = 0;//longest frame
+unsigned long _charWorstUs = FRAME_CHAR_US;//recent worst time to write one character
+
+#ifdef KEYPAD
+// keypad legends, row by row
+const char _keys[KEYPAD_ROWS * KEYPAD_COLS + 1] PROGMEM = "123A456B789C*0#D";
+#endif
+
+#ifdef _PROF
+#define  SW_PROFILE sw_Profile
+#else
+#define  SW_PROFILE 0
+#endif
+
+// state machine, in flash, [state][event] -> action, next state
+const Transition _swTable[STATE_COUNT][EV_COUNT] PROGMEM =
+{
+	//EV_LEFT                   EV_RIGHT                    EV_ICP                  EV_HOLD
+	{ { sw_Start, RUN },        { SW_PROFILE, IDLE },       { sw_Start, RUN },      { sw_Review, REVIEW } },//IDLE
+	{ { sw_Lap, RUN },          { sw_Pause, STOP },         { sw_Pause, STOP },     { 0, RUN } },//RUN
+	{ { sw_Start, RUN },        { sw_Reset, RESET },        { sw_Start, RUN },      { sw_Review, REVIEW } },//STOP
+	{ { sw_Start, RUN },        { 0, RESET },               { sw_Start, RUN },      { sw_Review, REVIEW } },//RESET
+	{ { sw_ReviewNext, REVIEW },{ sw_ReviewEnd, STOP },     { 0, REVIEW },          { sw_ReviewNext, REVIEW } }//REVIEW
+};
+
+// task table, in flash, [task] -> run, period, deadline (ticks, 0 for the period), events
+const Sched_Task _tasks[TASK_COUNT] PROGMEM =
+{
+	//run               period              deadline                events
+	{ task_Input,       0,                  INPUT_DEADLINE_TICKS,   TASK_EV_INPUT | TASK_EV_HOST },//INPUT
+	{ task_Fold,        TICKS_PER_UPDATE,   0,                      0 },//FOLD, enabled while running
+	{ task_Render,      0,                  TICKS_PER_UPDATE,       TASK_EV_REDRAW },//RENDER
+	{ task_Telem,       TELEM_TICKS,        0,                      0 },//TELEM
+#ifdef POWER_BENCH
+	{ power_Bench,      BENCH_TICKS,        0,                      0 },//BENCH
+#endif
+};
+
+// state names, in flash (after "State : " on the LCD, alone on the OLED)
+const char _stateText[STATE_COUNT][8] PROGMEM =
+{
+	"Idle",
+	"Running",
+	"Stop",
+	"Reset",
+	"Review"
+};
 
-char rxTime[80] = {0}; // array to diplay time
-	
-SwState _leftButton = Idle;
-SwState _rightButton = Idle;
-	
 
 int main(void)
 {
 /********************************************************************/
 // initializations
 /********************************************************************/
+	Power_Init();//everything off, each init below turns its own module back on
 	init_portB();//buttons
 	
-	Timer_Init(Timer_Prescale_64, _Timer_OC_Offset); // 100ms intervals, ISR
-	
-	// jump up to 8MHz, as 2MHz is a little slow
-	// 11.11.2 ATmega328PB Full
-	CLKPR = 0b10000000; // enable changes
-	CLKPR = 0b00000001; // set to div by 2 (16 / 2 = 8MHz)
+	Clock_Init(CLOCK_SOURCE, CLOCK_FAST, clock_Changed); // CLKPR, everything below takes Clock_Hz
+	Timer_Init(Timer_Prescale_64, Clock_Hz() / 64 / SERVICE_TICK_HZ); // 10ms intervals, ISR
+	Timer_SetCpuClock(Clock_Hz()); // for Timer_Micros
+	Sched_Init(_tasks, TASK_COUNT); // after the service tick
+	Timer_Capture_Init(Timer_Capture_Falling, 1); // ICP1 button, press pulls low
+	Timer_Capture_SetCallback(task_PostInput);
+	Button_Init((1 << BUTTON1) | (1 << BUTTON2) | (1 << BUTTON_ICP), BUTTON_LEFT); // pin change wake-up and debounce (ICP1 for the wake-up only), left can be held
+	Button_SetCallback(task_PostInput);
+	EELog_Init(); // find the newest lap in EEPROM
 	
 	
+#ifndef LED_HW_1HZ
 	DDRD |= 1 << PORTD7; // make portd pin 7 an output (PD7)
+#endif
 	
-	I2C_Init(F_CPU,I2CBus100);
-	sleep_enable();
+	I2C_Init(Clock_Hz(),I2CBus100);
+#ifdef LCD_SOFT_I2C
+	(void)I2C_SoftInit(LCD_BUS,&PORTC,PORTC0,PORTC1,Clock_Hz(),I2CBus100); // PCF8574A is a 100kHz part
+	LCD_SetBus(LCD_BUS);
+#endif
+#ifdef KEYPAD
+	(void)Keypad_Init(LCD_BUS,EXPANDER_ADDR,_keys); // INT0, scanned from the input task
+	Keypad_SetCallback(task_PostInput);
+#endif
+	UART_Init(Clock_Hz(),TELEM_BAUD);
+	UART_SetRxCallback(task_PostHost);
 	
-	LCD_Init(F_CPU);
+	(void)LCD_Init(Clock_Hz()); // without an LCD its transfers fail fast (LCD_Health), the rest runs on, a failed init is redone before the next write
+#ifdef OLED_MIRROR
+	oled_Init();
+#endif
 	sei();
+	Telem_Init(); // hello, with the Timer1 rate the host needs for profiling
+	
+#ifdef POWER_TICKLESS
+	Power_Timebase(1); // timer 2 on the watch crystal
+#endif
 	
+	Sched_Enable(TASK_INPUT, 1);
+	Sched_Enable(TASK_RENDER, 1);
+	Sched_Enable(TASK_TELEM, 1);
+#ifdef POWER_BENCH
+	Sched_Enable(TASK_BENCH, 1);
+#endif
 	
 	LCD_Clear();
-	(void)sprintf(rxTime,"Time : %02d:%02d:%02d",_hours,_minutes,_seconds);
-	LCD_StringXY(0,0,rxTime);
-	LCD_StringXY(0,1,"State : Idle");
+	_lcd = Console_Init(&_lcdConsole,&Console_Lcd,0); // on the cleared LCD
+#ifdef OLED_MIRROR
+	_oled = Console_Init(&_oledConsole,&Console_Oled,SSD1306_Selected()); // cleared by oled_Init
+#endif
+#ifdef I2C_BENCH
+	i2c_Bench();
+#endif
+	_redraw = REDRAW_TIME | REDRAW_STATE;
+	Sched_Post(TASK_EV_INPUT | TASK_EV_REDRAW); // anything held at power up, and the first frame
 	
 	
 /********************************************************************/
@@ -134,148 +446,910 @@ int main(void)
 /********************************************************************/
 	while(1)
 	{
-		sleep_cpu();//sleeping CPU
+		if(Sched_Dispatch())//one task, the highest ready, then look again
+			continue;
 		
-		if(_state == IDLE && (Sw_Process(&_leftButton, SWL_LEFT) == Pressed))// if state is idle then we will only accept button to start only 
+		// nothing ready, sleep until the next release or an input
+		if(!_memAlarm && Mem_Alarm())//a few bytes looked at, report it straight away, once
 		{
-			_state = RUN;
+			_memAlarm = 1;
+			(void)telem_Mem();
 		}
-		
-		//Switch case for all states
-		switch (_state)
+		if(_state != RUN)
+			clock_Pace(CLOCK_SLOW);
+		cli();//a post from here on would be slept through, look again with interrupts off
+		if(Sched_Pending())
 		{
-			case RUN:
-				sw_Run(); // running the stopwatch
-				if(Sw_Process(&_rightButton, SWL_RIGHT) == Pressed)//we could only stop , no any other button response required
-				{
-					_state = STOP;
-				}
-				break;
-			
-			case STOP:
-				if(Sw_Process(&_leftButton, SWL_LEFT) == Pressed) // if user want to start again
-				{
-					_state = RUN;
-				}
-				if(Sw_Process(&_rightButton, SWL_RIGHT) == Pressed) // if user want to reset
-				{
-					_state = RESET;
-				}
-				sw_Stop();
-				break;
-			
-			case RESET:
-				sw_Reset();
-				if(Sw_Process(&_leftButton, SWL_LEFT) == Pressed)// after reset user can only start the SW
-				{
-					_state = RUN;
-				}
-				break;
-			
-			default:
-			break;
+			sei();
+			continue;
+		}
+#ifdef POWER_TICKLESS
+		if(_state != RUN && !Button_Busy() && !EELog_Busy() && !UART_Busy() && !I2C_Busy())//Timer1 only needs to run while timing (ICP1, Timer_Micros) or debouncing, EE_READY, USART and TWI can't wake power-save
+		{
+			if(Power_Save() & Power_Wake_Pin)//sleeping CPU until the next timer or a button
+			{
+				_wokePin = 1;
+				Sched_Post(TASK_EV_INPUT);
+			}
+		}
+		else
+#endif
+		{
+			if(_state != RUN && !Button_Busy())//the 10ms tick only while running or debouncing
+				Timer_Tickless();//Timer1 compare on the next software timer due instead
+			Power_Idle();//sleeping CPU, interrupts back on with the sleep
 		}
 	}
-}//****************************************************************************************** **
-// void sw_Run()
-//Purpose: This function will increments all the constraints 
+}
+
+//****************************************************************************************** **
+// void task_Input()
+//Purpose: This function will run each input through the state table, released by the
+//         button, capture and UART receive ISRs (and a pin change wake from power-save)
 //Parameters: no
 //Returns: nothing
-//****************************************************************************************** **void sw_Run(){	if(_secondCounter >=10)//counter is incrementing after every 100 ms
+//****************************************************************************************** **
+void task_Input()
+{
+	sw_Capture();//ICP1 start/stop, before anything folds time
+	if(_wokePin)
 	{
-		_secondCounter =0;
-		PORTD |= 0b10000000; // turning on LED after every one second
+		_wokePin = 0;
+		sw_CaptureMissed();
+	}
+	sw_Buttons();
+#ifdef KEYPAD
+	sw_Keys();
+#endif
+	
+	if(Telem_Poll())//host requests
+		telem_Counters();
+	if(_redraw)
+		Sched_Post(TASK_EV_REDRAW);
+}
+
+//****************************************************************************************** **
+// void task_Fold()
+//Purpose: This function will keep the time while running, once a display frame
+//Parameters: no
+//Returns: nothing
+//****************************************************************************************** **
+void task_Fold()
+{
+	sw_Tick();
+	if(_redraw)
+		Sched_Post(TASK_EV_REDRAW);
+}
+
+//****************************************************************************************** **
+// void task_Render()
+//Purpose: This function will draw one display frame at the fast clock, what didn't fit the
+//         frame budget releases the task again, behind anything more urgent
+//Parameters: no
+//Returns: nothing
+//****************************************************************************************** **
+void task_Render()
+{
+	clock_Pace(CLOCK_FAST);
+	UpdateLCD();
+	if(_redraw)
+		Sched_Post(TASK_EV_REDRAW);
+}
+
+//****************************************************************************************** **
+// void task_Telem()
+//Purpose: This function will send the counters frames
+//Parameters: no
+//Returns: nothing
+//****************************************************************************************** **
+void task_Telem()
+{
+	(void)Telem_I2C();
+	Telem_Prof();
+	telem_Counters();
+}
+
+//****************************************************************************************** **
+// void task_PostInput()
+//Purpose: This function will release the input task, runs in the button tick / capture ISRs
+//Parameters: no
+//Returns: nothing
+//****************************************************************************************** **
+void task_PostInput()
+{
+	Sched_Post(TASK_EV_INPUT);
+}
+
+//****************************************************************************************** **
+// void task_PostHost()
+//Purpose: This function will release the input task for a host request, runs in the UART
+//         receive ISR
+//Parameters: no
+//Returns: nothing
+//****************************************************************************************** **
+void task_PostHost()
+{
+	Sched_Post(TASK_EV_HOST);
+}
+
+//****************************************************************************************** **
+// void sw_Dispatch(unsigned char event, unsigned long nowUs)
+//Purpose: This function will look up the current state and the event in the state table,
+//         run the action and move to the next state, a state change asks for a redraw
+//Parameters: event - EV_ input, nowUs - Timer_Micros time of the event
+//Returns: nothing
+//****************************************************************************************** **
+void sw_Dispatch(unsigned char event, unsigned long nowUs)
+{
+	const Transition * t = &_swTable[_state][event];
+	void (*action)(unsigned long) = (void (*)(unsigned long))pgm_read_word(&t->action);
+	unsigned char next = pgm_read_byte(&t->next);
+	
+	(void)Telem_State(nowUs, _state, event, next);//dropped if the UART is behind, never waits
+	if(action)
+		action(nowUs);
+	if(next != _state)
+	{
+		_state = next;
+		_redraw |= REDRAW_STATE;
+	}
+}
+
+//****************************************************************************************** **
+// void sw_Tick()
+//Purpose: This function will fold the running time, the time line is only redrawn when the
+//         time shown (seconds, or centiseconds in TIME_CS) has changed
+//Parameters: no
+//Returns: nothing
+//****************************************************************************************** **
+void sw_Tick()
+{
+	unsigned long lastShown = _elapsedCs / TIME_UNIT_CS;
+	
+	PROF_BEGIN(PROF_FOLD);
+	sw_Fold(Timer_Micros());
+	PROF_END(PROF_FOLD);
+	(void)Telem_Time(_lastUs, _elapsedCs, 0);
+	if(_elapsedCs / TIME_UNIT_CS != lastShown)
+		_redraw |= REDRAW_TIME;
+}
+
+//****************************************************************************************** **
+// void sw_Reset(unsigned long nowUs)
+//Purpose: This function will reset all the constraint 
+//Parameters: nowUs - not used (state table action)
+//Returns: nothing
+//****************************************************************************************** **
+void sw_Reset(unsigned long nowUs)
+{
+	(void)nowUs;
+	_seconds=00, _minutes = 00, _hours =00;
+	_elapsedCs = 0, _elapsedUs = 0;
+	_lap = 0, _lastSplitCs = 0;
+	_redraw |= REDRAW_TIME;
+}
+
+//****************************************************************************************** **
+// void sw_Start(unsigned long nowUs)
+//Purpose: This function will start the time counting from nowUs (state table action)
+//Parameters: nowUs - Timer_Micros time of the start (now, or a captured stamp)
+//Returns: nothing
+//****************************************************************************************** **
+void sw_Start(unsigned long nowUs)
+{
+	_lastUs = nowUs;
+	led_Start();
+	Sched_Enable(TASK_FOLD, 1); // fold and display frame, 20 Hz (10 Hz without TIME_CS)
+}
+
+//****************************************************************************************** **
+// void sw_Pause(unsigned long nowUs)
+//Purpose: This function will stop the time counting, time up to nowUs is kept (state table action)
+//Parameters: nowUs - Timer_Micros time of the stop (now, or a captured stamp)
+//Returns: nothing
+//****************************************************************************************** **
+void sw_Pause(unsigned long nowUs)
+{
+	sw_Fold(nowUs);
+	led_Stop();
+	Sched_Enable(TASK_FOLD, 0); // nothing changes while stopped
+	_redraw |= REDRAW_TIME;
+}
+
+//****************************************************************************************** **
+// void sw_Profile(unsigned long nowUs)
+//Purpose: This function will show the profiling probes on the LCD (state table action)
+//Parameters: nowUs - not used
+//Returns: nothing
+//****************************************************************************************** **
+void sw_Profile(unsigned long nowUs)
+{
+	(void)nowUs;
+	PROF_DUMP(prof_Show);
+	time_Invalidate();//shown over the time
+}
+
+//****************************************************************************************** **
+// void sw_Lap(unsigned long nowUs)
+//Purpose: This function will take a split at nowUs and queue it to the EEPROM log, the write
+//         is done by the EE_READY interrupt so timing carries straight on (state table action)
+//Parameters: nowUs - Timer_Micros time of the lap (stamped at the press)
+//Returns: nothing
+//****************************************************************************************** **
+void sw_Lap(unsigned long nowUs)
+{
+	sw_Fold(nowUs);
+	if(_lap < LAP_MAX)
+		++_lap;
+	_lastLapCs = _elapsedCs - _lastSplitCs;
+	_lastSplitCs = _elapsedCs;
+	(void)EELog_Put(_elapsedCs, _lap);//queue full only if laps come faster than 27ms, the LCD still shows it
+	(void)Telem_Time(nowUs, _elapsedCs, _lap);
+	_redraw |= REDRAW_TIME | REDRAW_LAP;
+}
+
+//****************************************************************************************** **
+// void sw_Review(unsigned long nowUs)
+//Purpose: This function will start review on the newest lap in the log (state table action)
+//Parameters: nowUs - not used
+//Returns: nothing
+//****************************************************************************************** **
+void sw_Review(unsigned long nowUs)
+{
+	(void)nowUs;
+	_reviewAge = 0;
+	_redraw |= REDRAW_TIME;
+}
+
+//****************************************************************************************** **
+// void sw_ReviewNext(unsigned long nowUs)
+//Purpose: This function will page to the next older lap, back to the newest after the oldest
+//         (state table action)
+//Parameters: nowUs - not used
+//Returns: nothing
+//****************************************************************************************** **
+void sw_ReviewNext(unsigned long nowUs)
+{
+	(void)nowUs;
+	if(++_reviewAge >= EELog_Count())
+		_reviewAge = 0;
+	_redraw |= REDRAW_TIME;
+}
+
+//****************************************************************************************** **
+// void sw_ReviewEnd(unsigned long nowUs)
+//Purpose: This function will leave review, the time is shown again (state table action)
+//Parameters: nowUs - not used
+//Returns: nothing
+//****************************************************************************************** **
+void sw_ReviewEnd(unsigned long nowUs)
+{
+	(void)nowUs;
+	time_Invalidate();//the laps were over it
+	_redraw |= REDRAW_TIME;
+}
+
+//****************************************************************************************** **
+// void sw_Fold(unsigned long nowUs)
+//Purpose: This function will add the time since the last fold to the stopwatch, the remainder
+//         below a centisecond is carried so nothing is lost (no drift), then derive hh:mm:ss
+//         must run more often than Timer_Micros wraps (71 minutes), the running tick does
+//         a captured stamp can be a little older than the last fold, so the step may be negative
+//Parameters: nowUs - Timer_Micros time to fold up to
+//Returns: nothing
+//****************************************************************************************** **
+void sw_Fold(unsigned long nowUs)
+{
+	long us = (long)_elapsedUs + (long)(nowUs - _lastUs);
+	_lastUs = nowUs;
+	
+	while(us < 0 && _elapsedCs)//borrow back from whole centiseconds
+	{
+		us += 10000;
+		--_elapsedCs;
+	}
+	if(us < 0)
+		us = 0;
+	
+	_elapsedCs += us / 10000;
+	_elapsedUs = us % 10000;
+	
+	unsigned long totalSeconds = _elapsedCs / 100;
+	_hours = totalSeconds / 3600;
+	_minutes = (totalSeconds / 60) % 60;
+	_seconds = totalSeconds % 60;
+}
+
+//****************************************************************************************** **
+// void sw_Capture()
+//Purpose: This function will start or stop the stopwatch at the exact time the ICP1 button
+//         edge was captured by the timer, instead of when the CPU got around to polling it
+//Parameters: no
+//Returns: nothing
+//****************************************************************************************** **
+void sw_Capture()
+{
+	unsigned long stampUs;
+	
+	while(Timer_Capture_Get(0, &stampUs))
+	{
+		if(stampUs - _lastCaptureUs < CAPTURE_LOCKOUT_US)//bounce of the last press
+			continue;
+		_lastCaptureUs = stampUs;
 		
-		++_seconds;// incrementing counter
+		sw_Dispatch(EV_ICP, stampUs);
+	}
+}
+
+//****************************************************************************************** **
+// void sw_CaptureMissed()
+//Purpose: This function will start the stopwatch on an ICP1 press that woke us from power-save,
+//         Timer1 was stopped so the edge has no capture stamp, the wake-up time is used
+//Parameters: no
+//Returns: nothing
+//****************************************************************************************** **
+void sw_CaptureMissed()
+{
+	unsigned long nowUs = Timer_Micros();
+	
+	if(PINB & (1 << BUTTON_ICP))//not pressed
+		return;
+	if(nowUs - _lastCaptureUs < CAPTURE_LOCKOUT_US)//stamped after all, or bounce
+		return;
+	_lastCaptureUs = nowUs;
+	
+	if(_state != RUN)
+		sw_Dispatch(EV_ICP, nowUs);
+}
+
+//****************************************************************************************** **
+// void power_Bench()
+//Purpose: This function will show wake-ups per hour on the LCD, the benchmark for power-save
+//         or for the tickless idle (the benchmark timer itself adds 60 an hour)
+//Parameters: no
+//Returns: nothing
+//****************************************************************************************** **
+void power_Bench()
+{
+	unsigned long seconds = Power_Seconds();
+	
+	if(!seconds)//no timebase, the service ticks are counted across the tickless sleep too
+		seconds = Timer_TickCount() / SERVICE_TICK_HZ;
+	if(!seconds)
+		return;
+	Console_GotoXY(_lcd,0,1);
+	(void)fprintf_P(_lcd,PSTR("Wake/h : %lu\n"),(unsigned long)((unsigned long long)Power_Wakeups() * 3600 / seconds));
+	Console_Flush(_lcd);
+}
+
+#ifdef I2C_BENCH
+//****************************************************************************************** **
+// void i2c_Bench()
+//Purpose: This function will time the I2C lanes: whole OLED frames (SSD1306_Clear) on the TWI,
+//         whole LCD redraws (every character changed) on the LCD's bus, then both together,
+//         bytes are from the bus counters, each run goes out as a TELEM_BUS frame
+//Parameters: no
+//Returns: nothing
+//****************************************************************************************** **
+void i2c_Bench()
+{
+	for(unsigned char lane = 0; lane < 3; ++lane)//0 OLED, 1 LCD, 2 both
+	{
+		I2C_Counters twi, lcd, twiEnd, lcdEnd;
+		unsigned long bytes;
+		unsigned long us;
 		
-		if(_seconds >=60)//if time is = 60 then reseting second and increasing minute
-		{
-			_seconds=0;
-			++_minutes;
-		}
-		if(_minutes>=60)
+		I2C_GetCounters(&twi);
+		I2C_BusGetCounters(LCD_BUS,&lcd);
+		us = Timer_Micros();
+		for(unsigned char pass = 0; pass < I2C_BENCH_PASSES; ++pass)
 		{
-			_minutes=0;
-			++_hours;
+			if(lane != 1)
+				SSD1306_Clear();//may still be going out from the TWI interrupt
+			if(lane != 0)
+			{
+				for(unsigned char row = 0; row < CONSOLE_LCD_ROWS; ++row)
+				{
+					Console_GotoXY(_lcd,0,row);
+					for(unsigned char i = 0; i < CONSOLE_LCD_COLS; ++i)
+						(void)fputc('A' + pass,_lcd);
+				}
+				Console_Flush(_lcd);
+			}
 		}
+		while(SSD1306_Busy())
+			;
+		us = Timer_Micros() - us;
+		
+		I2C_GetCounters(&twiEnd);
+		I2C_BusGetCounters(LCD_BUS,&lcdEnd);
+		bytes = twiEnd.ulBytes - twi.ulBytes;
+		if(LCD_BUS != I2C_HW)//on the TWI it is in the TWI counters already
+			bytes += lcdEnd.ulBytes - lcd.ulBytes;
+		(void)Telem_Bus(lane,bytes,us);
 	}
-	else
+	
+	(void)fputc('\f',_lcd);
+	Console_Flush(_lcd);
+}
+#endif
+
+#ifdef _PROF
+//****************************************************************************************** **
+// void prof_Show(unsigned char id, const char * line)
+//Purpose: This function will show one profiling line (id min/avg/max us) on the LCD,
+//         two probes fit, the rest are shown over them
+//Parameters: id - probe, line - formatted probe line
+//Returns: nothing
+//****************************************************************************************** **
+void prof_Show(unsigned char id, const char * line)
+{
+	Console_GotoXY(_lcd,0,id & 1);
+	(void)fprintf_P(_lcd,PSTR("%s\n"),line);//clipped at the right edge
+	Console_Flush(_lcd);
+}
+#endif
+
+//****************************************************************************************** **
+// void clock_Pace(Clock_Div div)
+//Purpose: This function will change the CPU clock, if it isn't there already, once the UART
+//         has nothing on the wire (a byte being shifted out would be garbled). The slow clock
+//         waits for CLOCK_QUIET_TICKS without a call for the fast one, so an idle frame or a
+//         few close together don't switch the clock back and forth each time
+//Parameters: div - CLOCK_FAST or CLOCK_SLOW
+//Returns: nothing
+//****************************************************************************************** **
+void clock_Pace(Clock_Div div)
+{
+	if(div == CLOCK_FAST)
+	{
+		_fastTick = Timer_TickCount();
+		Timer_Start(&_tQuiet, CLOCK_QUIET_TICKS, 0, 0);//the wake is enough, power-save included
+	}
+	if(div == _clockDiv)
+		return;
+	if(div == CLOCK_SLOW && Timer_TickCount() - _fastTick < CLOCK_QUIET_TICKS)//not quiet for long enough
+		return;
+	if(div == CLOCK_SLOW && UART_Busy())//try again next time round
+		return;
+	while(UART_Busy())//going fast can't wait (only sends at a slow clock that has the baud rate)
+		;
+	_clockDiv = div;
+	(void)Clock_Set(div);
+}
+
+//****************************************************************************************** **
+// void clock_Changed(unsigned long cpuHz)
+//Purpose: This function will move the app's own modules to a new CPU clock, Timer1, the I2C
+//         bit rate and the delays have been moved by the clock library already
+//Parameters: cpuHz - new CPU clock
+//Returns: nothing
+//****************************************************************************************** **
+void clock_Changed(unsigned long cpuHz)
+{
+	(void)UART_SetBusRate(cpuHz);//off at 1MHz, telemetry waits in the ring
+	Button_Retime();
+	(void)Telem_Hello();//the host's Timer1 rate for profiling
+}
+
+//****************************************************************************************** **
+// void telem_Counters()
+//Purpose: This function will send the display frame counters, the SRAM use and the task
+//         counters, the rest of the counters are sent by the telemetry library
+//Parameters: no
+//Returns: nothing
+//****************************************************************************************** **
+void telem_Counters()
+{
+	(void)Telem_Frames(_frames,_frameOverruns,_frameDeferred,_frameWorstUs);
+	(void)telem_Mem();//stack high-water mark, the gap left
+	telem_Tasks();
+}
+
+//****************************************************************************************** **
+// void telem_Tasks()
+//Purpose: This function will send a TELEM_TASK frame for each task in the scheduler table
+//Parameters: no
+//Returns: nothing
+//****************************************************************************************** **
+void telem_Tasks()
+{
+	unsigned char pay[11];
+	Sched_Stat stat;
+	
+	for(unsigned char i = 0; Sched_Read(i,&stat); ++i)
 	{
-		PORTD &= ~(0b10000000); // turning off LED
+		unsigned char * at = pay;
+		
+		*at++ = i;
+		at = telem_U32(at,stat.ulRuns);
+		at = telem_U32(at,stat.ulWorstUs);
+		at = telem_U16(at,stat.uiMisses);
+		(void)Telem_Frame(TELEM_TASK,pay,at - pay);
 	}
-	UpdateLCD();//updating LCD
-}//****************************************************************************************** **
-// void sw_Stop()
-//Purpose: This function will only work when state is stop
+}
+
+//****************************************************************************************** **
+// int telem_Mem()
+//Purpose: This function will send the SRAM use (mem.h) as a TELEM_MEM frame
+//Parameters: no
+//Returns: 0 if the frame was dropped
+//****************************************************************************************** **
+int telem_Mem()
+{
+	unsigned char pay[9];
+	unsigned char * at = pay;
+	Mem_Stat stat;
+	
+	Mem_Read(&stat);
+	at = telem_U16(at,stat.uiStatic);
+	at = telem_U16(at,stat.uiGap);
+	at = telem_U16(at,stat.uiLeast);
+	at = telem_U16(at,stat.uiStackPeak);
+	*at++ = Mem_Alarm();
+	return Telem_Frame(TELEM_MEM,pay,at - pay);
+}
+
+//****************************************************************************************** **
+// unsigned char * telem_U16(unsigned char * at, unsigned int value)
+//Purpose: This function will put a u16 into a telemetry payload, little endian (telem.h)
+//Parameters: at - where it goes, value - the u16
+//Returns: the byte after it
+//****************************************************************************************** **
+unsigned char * telem_U16(unsigned char * at, unsigned int value)
+{
+	*at++ = value;
+	*at++ = value >> 8;
+	return at;
+}
+
+//****************************************************************************************** **
+// unsigned char * telem_U32(unsigned char * at, unsigned long value)
+//Purpose: This function will put a u32 into a telemetry payload, little endian (telem.h)
+//Parameters: at - where it goes, value - the u32
+//Returns: the byte after it
+//****************************************************************************************** **
+unsigned char * telem_U32(unsigned char * at, unsigned long value)
+{
+	at = telem_U16(at,value);
+	return telem_U16(at,value >> 16);
+}
+
+//****************************************************************************************** **
+// void led_Start()
+//Purpose: This function will start the 1 Hz LED, on for the first half second
 //Parameters: no
 //Returns: nothing
-//****************************************************************************************** **void sw_Stop(){	UpdateLCD();}//****************************************************************************************** **
-// void sw_Reset()
-//Purpose: This function will reset all the constraint 
+//****************************************************************************************** **
+void led_Start()
+{
+#ifdef LED_HW_1HZ
+#ifdef POWER_TICKLESS
+	Power_Timebase(0); // timer 2 is the LED while running
+#endif
+	PWM_Timer2Async(1); // watch crystal
+	PWM_Init(PWM_Timer2, PWM_Mode_Square, PWM_Top_OCRA, 32768, 1); // 1 Hz
+	PWM_Enable(PWM_Timer2, PWM_Channel_B, PWM_Pol_NonInverting);
+#else
+	PORTD |= 0b10000000; // turning on LED
+	Timer_Start(&_tLed, LED_HALF_TICKS, LED_HALF_TICKS, led_Toggle);
+#endif
+}
+
+//****************************************************************************************** **
+// void led_Stop()
+//Purpose: This function will stop the 1 Hz LED and turn it off
 //Parameters: no
 //Returns: nothing
-//****************************************************************************************** **void sw_Reset(){	_seconds=00, _minutes = 00, _hours =00;	UpdateLCD();}//****************************************************************************************** **
+//****************************************************************************************** **
+void led_Stop()
+{
+#ifdef LED_HW_1HZ
+	PWM_Disable(PWM_Timer2, PWM_Channel_B);
+#ifdef POWER_TICKLESS
+	Power_Timebase(1); // timer 2 back to keeping time
+#endif
+#else
+	Timer_Stop(&_tLed);
+	PORTD &= ~(0b10000000); // turning off LED
+#endif
+}
+
+//****************************************************************************************** **
+// void led_Toggle()
+//Purpose: This function will toggle the software LED, runs in the service tick ISR
+//Parameters: no
+//Returns: nothing
+//****************************************************************************************** **
+void led_Toggle()
+{
+	PIND = 0b10000000; // writing 1 to PIN toggles the PORT bit
+}
+
+//****************************************************************************************** **
 // void UpdateLCD()
-//Purpose: This function will update LCD 
+//Purpose: This function will redraw the parts of the LCD asked for in _redraw
 //Parameters: no
 //Returns: nothing
-//****************************************************************************************** **void UpdateLCD(){	//updating LCD after every 500 ms
-	if(_Update>=5)
+//****************************************************************************************** **
+void UpdateLCD()
+{
+	char line[TIME_CHARS + 1];//the time is compared character by character
+	unsigned long startUs = Timer_Micros();
+	unsigned char pending = 0;//left for the next pass
+	
+	PROF_BEGIN(PROF_UPDATE_LCD);
+	if(_state == REVIEW)//the lap takes both lines
+	{
+		review_Show();
+		_redraw = 0;
+	}
+	
+	if(_redraw & REDRAW_TIME)
+	{
+#ifdef TIME_CS
+		(void)sprintf(line,"%02u:%02u:%02u.%02u",_hours % 100,_minutes,_seconds,(unsigned int)(_elapsedCs % 100));
+#else
+		(void)sprintf(line,"%02u:%02u:%02u",_hours % 100,_minutes,_seconds);
+#endif
+		PROF_BEGIN(PROF_LCD_STRING);
+		if(time_Show(line,startUs))
+			pending |= REDRAW_TIME;
+		PROF_END(PROF_LCD_STRING);
+	}
+	
+#ifndef POWER_BENCH
+	// displaying the state on LCD  
+	if(_redraw & REDRAW_STATE)
+	{
+		Console_GotoXY(_lcd,0,1);
+		(void)fputs_P(PSTR("State : "),_lcd);
+		state_Show(_lcd);
+#ifdef OLED_MIRROR
+		Console_GotoXY(_oled,7,OLED_STATE_BANK);
+		state_Show(_oled);
+#endif
+	}
+	else if(_redraw & REDRAW_LAP)//running, the last lap until the state changes
+	{
+		Console_GotoXY(_lcd,0,1);
+		(void)fprintf_P(_lcd,PSTR("L%03u "),_lap);
+		sw_PrintCs(_lcd,_lastLapCs);
+		(void)fputc('\n',_lcd);
+		Console_Flush(_lcd);
+	}
+#endif
+	_redraw = pending;
+	PROF_END(PROF_UPDATE_LCD);
+	
+	startUs = Timer_Micros() - startUs;
+	++_frames;
+	if(startUs > _frameWorstUs)
+		_frameWorstUs = startUs;
+	if(startUs > FRAME_BUDGET_US)
+		++_frameOverruns;
+}
+
+//****************************************************************************************** **
+// void state_Show(FILE * out)
+//Purpose: This function will print the state name at the cursor of a console, clear the rest
+//         of the line and send it
+//Parameters: out - console stream (console.h)
+//Returns: nothing
+//****************************************************************************************** **
+void state_Show(FILE * out)
+{
+	(void)fputs_P(_stateText[_state],out);
+	(void)fputc('\n',out);
+	Console_Flush(out);
+}
+
+//****************************************************************************************** **
+// unsigned char time_Show(const char * text, unsigned long startUs)
+//Purpose: This function will write the characters of the time that changed since the last
+//         redraw, each run of changed characters is one LCD transaction and one OLED window.
+//         A run only goes out if it fits what is left of the frame budget, at the recent
+//         worst time per character, so the frame can't run long
+//Parameters: text - TIME_LAYOUT time, startUs - Timer_Micros at the start of the frame
+//Returns: 1 if characters were left for the next pass, 0 if the time is all shown
+//****************************************************************************************** **
+unsigned char time_Show(const char * text, unsigned long startUs)
+{
+	unsigned char i = 0;
+	unsigned char drawn = 0;
+	
+	if(!_shownTime[0])//invalidated, the label may be gone too
 	{
-		_Update = 0; //reseting count
-		char rxTime[80] = {0};
-		(void)sprintf(rxTime,"Time : %02d:%02d:%02d",_hours,_minutes,_seconds);
-		LCD_StringXY(0,0,rxTime);
+		Console_GotoXY(_lcd,0,0);
+		(void)fputs_P(PSTR(TIME_LABEL),_lcd);
+		Console_Flush(_lcd);//on its own, so the runs time only their own characters
+	}
+	
+	while(i < TIME_CHARS && text[i])
+	{
+		unsigned char start = i;
+		unsigned long usedUs, runUs;
+		unsigned char fit;
 		
-		// displaying the state on LCD  
-		if(_state == IDLE)
-			LCD_StringXY(0,1,"State : Idle   ");
-		if(_state == RUN)
-			LCD_StringXY(0,1,"State : Running");
-		if(_state == STOP)
-			LCD_StringXY(0,1,"State : Stop   ");
-		if(_state == RESET)
-			LCD_StringXY(0,1,"State : Reset  ");
+		if(text[i] == _shownTime[i])
+		{
+			++i;
+			continue;
+		}
 		
-	}}// is a specific switch being pushed (T/F)
-int SWL_Pushed(SWL_SwitchPos button)
-{
-	return (!(PINB & (1<<button))) ? 1 : 0;
-}// Optional - Using
-SwState Sw_Process(SwState* state, SWL_SwitchPos sw)
-{
-	if(SWL_Pushed(sw))
-	{//Switch active
-		if(*state == Idle)
+		usedUs = Timer_Micros() - startUs;
+		fit = usedUs < FRAME_BUDGET_US ? (FRAME_BUDGET_US - usedUs) / _charWorstUs : 0;
+		if(!fit && !drawn)//always make some headway
+			fit = 1;
+		if(!fit)
 		{
-			*state = Pressed;
+			++_frameDeferred;
+			return 1;
 		}
-		else
+		
+		runUs = Timer_Micros();
+		Console_GotoXY(_lcd,TIME_LCD_X + start,0);
+		while(i < TIME_CHARS && text[i] && text[i] != _shownTime[i] && i - start < fit)
 		{
-			*state = Held;
+			(void)fputc(text[i],_lcd);
+			_shownTime[i] = text[i];
+#ifdef OLED_MIRROR
+			(void)SSD1306_FontCharXY(&OLED_FONT,_oledX[i],0,text[i],SSD1306_BLIT_OVERWRITE);
+#endif
+			++i;
 		}
+		Console_Flush(_lcd);
+#ifdef OLED_MIRROR
+		SSD1306_Render();//just the columns of this run
+#endif
+		
+		drawn = 1;
+		runUs = (Timer_Micros() - runUs) / (i - start);
+		_charWorstUs -= _charWorstUs / 8;//decays, a sample over it takes over
+		if(runUs > _charWorstUs)
+			_charWorstUs = runUs;
+	}
+	return 0;
+}
+
+//****************************************************************************************** **
+// void time_Invalidate()
+//Purpose: This function will forget what time is shown, so the next redraw writes all of it
+//Parameters: no
+//Returns: nothing
+//****************************************************************************************** **
+void time_Invalidate()
+{
+	memset(_shownTime,0,sizeof(_shownTime));
+}
+
+#ifdef OLED_MIRROR
+//****************************************************************************************** **
+// void oled_Init()
+//Purpose: This function will bring up the OLED and work out where each time character goes,
+//         the digits are tabular so the cells never move, centred on the display
+//Parameters: no
+//Returns: nothing
+//****************************************************************************************** **
+void oled_Init()
+{
+	const char layout[TIME_CHARS + 1] = TIME_LAYOUT;
+	char prefix[TIME_CHARS + 1] = {0};
+	int spacing = SSD1306_FontStringWidth(&OLED_FONT,"00") - 2 * SSD1306_FontStringWidth(&OLED_FONT,"0");
+	int x0 = (SSD1306_Selected()->Width - SSD1306_FontStringWidth(&OLED_FONT,layout)) / 2;
+	
+	SSD1306_DispInit(SSD1306_OR_UP);//clears it
+	for(unsigned char i = 0; i < TIME_CHARS; ++i)
+	{
+		_oledX[i] = x0 + SSD1306_FontStringWidth(&OLED_FONT,prefix) + (i ? spacing : 0);
+		prefix[i] = layout[i];
 	}
+}
+#endif
+
+//****************************************************************************************** **
+// void review_Show()
+//Purpose: This function will show the lap under review, lap time on the top line and split on
+//         the bottom, the lap time needs the lap before it in the log (or is the split of lap 1)
+//Parameters: no
+//Returns: nothing
+//****************************************************************************************** **
+void review_Show()
+{
+	EELog_Record rec, prev;
+	
+	Console_GotoXY(_lcd,0,0);
+	if(!EELog_Read(_reviewAge,&rec))//nothing stored, or torn by a power loss
+	{
+		(void)fputs_P(PSTR("Lap : none\n\n"),_lcd);
+		Console_Flush(_lcd);
+		return;
+	}
+	
+	(void)fprintf_P(_lcd,PSTR("L%03u "),rec.ucTag);
+	if(rec.ucTag == 1)
+		sw_PrintCs(_lcd,rec.ulData);
+	else if(EELog_Read(_reviewAge + 1,&prev) && prev.ucTag == rec.ucTag - 1)
+		sw_PrintCs(_lcd,rec.ulData - prev.ulData);
 	else
-	{//Switch not-active
-		if(*state == Held)
-		{
-			*state = Released;
-		}
-		else
+		(void)fputs_P(PSTR("--:--:--.--"),_lcd);
+	
+	(void)fputs_P(PSTR("\nS    "),_lcd);
+	sw_PrintCs(_lcd,rec.ulData);
+	(void)fputc('\n',_lcd);
+	Console_Flush(_lcd);
+}
+
+//****************************************************************************************** **
+// void sw_PrintCs(FILE * out, unsigned long cs)
+//Purpose: This function will print a time in centiseconds as hh:mm:ss.cc (11 characters)
+//Parameters: out - stream (a console), cs - time in centiseconds
+//Returns: nothing
+//****************************************************************************************** **
+void sw_PrintCs(FILE * out, unsigned long cs)
+{
+	unsigned long totalSeconds = cs / 100;
+	
+	(void)fprintf_P(out,PSTR("%02lu:%02lu:%02lu.%02lu"),(totalSeconds / 3600) % 100,(totalSeconds / 60) % 60,totalSeconds % 60,cs % 100);
+}
+
+//****************************************************************************************** **
+// void sw_Buttons()
+//Purpose: This function will turn the presses queued by the button driver into events,
+//         each press is seen exactly once. The left button can be held, so it acts on the
+//         release unless it was held, stamped with the time of the press
+//Parameters: no
+//Returns: nothing
+//****************************************************************************************** **
+void sw_Buttons()
+{
+	Button_Event ev;
+	
+	while(Button_Get(&ev))
+	{
+		if(ev.ucMask & BUTTON_LEFT)
 		{
-			*state = Idle;
+			if(ev.type == Button_Press)
+			{
+				_leftUs = Timer_Micros();
+				_leftHeld = 0;
+			}
+			else if(ev.type == Button_Long || ev.type == Button_Repeat)
+			{
+				_leftHeld = 1;
+				sw_Dispatch(EV_HOLD, Timer_Micros());
+			}
+			else if(!_leftHeld)//released
+				sw_Dispatch(EV_LEFT, _leftUs);
 		}
+		if((ev.ucMask & BUTTON_RIGHT) && ev.type == Button_Press)
+			sw_Dispatch(EV_RIGHT, Timer_Micros());
+	}
+}
+
+#ifdef KEYPAD
+//****************************************************************************************** **
+// void sw_Keys()
+//Purpose: This function will have the keypad scanned if it has settled since a change, and
+//         turn key presses into the button events
+//Parameters: no
+//Returns: nothing
+//****************************************************************************************** **
+void sw_Keys()
+{
+	Keypad_Event ev;
+	
+	(void)Keypad_Poll();//nothing on the bus unless a key changed
+	while(Keypad_Get(&ev))
+	{
+		if(ev.type != Keypad_Press)
+			continue;
+		if(ev.cKey == KEY_LEFT)
+			sw_Dispatch(EV_LEFT, Timer_Micros());
+		else if(ev.cKey == KEY_RIGHT)
+			sw_Dispatch(EV_RIGHT, Timer_Micros());
+		else if(ev.cKey == KEY_HOLD)
+			sw_Dispatch(EV_HOLD, Timer_Micros());
 	}
-	return *state;
-}// output compare A interrupt
-ISR(TIMER1_COMPA_vect)
-{
-	// rearm the output compare operation
-	OCR1A += _Timer_OC_Offset; // 100ms intervals @ Prescale 64
-	
-	// count 100ms ticks!
-	++_Update;
-	
-	if(_state == RUN)//for accuracy we will only increment seconds if state is run
-		++_secondCounter;
 }
+#endif
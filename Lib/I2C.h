@@ -2,6 +2,15 @@
 // Simon Walker, NAIT
 // Revision History:
 // March 18 2022 - Initial Build
+// Oct 2026 - Transfer counters (I2C_GetCounters) for diagnostics
+// Oct 2026 - I2C_SetBusRate for clock changes (clock.h), TWPS is used
+// Oct 2026 - Software (bit-banged) buses on any two pins of a port, the
+//             start / write / read contract through a bus handle (I2C_Bus),
+//             interrupt driven writes on the TWI (I2C_WriteAsync)
+// Oct 2026 - Transactions (I2C_Transact): always closed with a STOP,
+//             retried with backoff, per device health (I2C_State)
+// Oct 2026 - Software bus bits in counted instructions, the SCL rate to the
+//             delay pass (400kHz and 100kHz exact from 16MHz)
 
 #define I2C_STOP 1
 #define I2C_NOSTOP 0
@@ -10,6 +19,14 @@
 #define I2C_ACK 1
 #define I2C_NACK 0
 
+// transfers since I2C_Init, an error is any step that got the wrong status
+typedef struct I2C_Counters
+{
+	unsigned long ulStarts;   // START + address sent
+	unsigned long ulBytes;    // data bytes read or written
+	unsigned int uiErrors;    // failed starts, reads and writes
+} I2C_Counters;
+
 // enum for desired I2C bus rate
 typedef enum
 {
@@ -17,12 +34,124 @@ typedef enum
 	I2CBus400   // I2C bus @ 400 kHz
 } I2C_BusRate;
 
+// a bus handle, I2C_HW is the TWI, a software bus is declared by the
+//  application and brought up with I2C_SoftInit, ex:
+//   I2C_Bus _LcdBus;
+//   I2C_SoftInit (&_LcdBus, &PORTC, PORTC0, PORTC1, Clock_Hz(), I2CBus100);
+//   LCD_SetBus (&_LcdBus);
+// a software bus is open drain by switching DDR (the PORT bits stay 0), so
+//  it needs pull-ups on both lines, as the TWI does
+// a bit is 34 cycles of counted instructions and 3 a delay pass in each
+//  half, the passes come from the CPU clock, rounded so the bus is never
+//  faster than asked for: 400kHz and 100kHz exactly from 16MHz, 200kHz at
+//  most from 8MHz, a slow clock gives a slower bus (the bench_i2c soft runs
+//  measure it). The rise time, interrupts and slaves stretching SCL (up to
+//  I2C_SOFT_STRETCH polls, then the step fails) only make a bit longer
+#ifndef I2C_SOFT_STRETCH
+#define I2C_SOFT_STRETCH 1000 // polls of SCL released before giving up
+#endif
+
+typedef struct I2C_Bus
+{
+	volatile unsigned char * pPort;   // PORTx of both pins (DDRx and PINx below it)
+	unsigned char ucSda;              // pin masks
+	unsigned char ucScl;
+	unsigned char ucLow;              // delay passes with SCL low
+	unsigned char ucHigh;             //  and high
+	unsigned char ucOpen;             // in a transaction, the next start is a restart
+	unsigned long ulScl;              // SCL rate asked for
+	I2C_Counters Counters;
+	struct I2C_Bus * pNext;           // software buses, retimed by I2C_SetBusRate
+} I2C_Bus;
+
+#define I2C_HW ((I2C_Bus *)0)
+
+// a transaction that didn't get started (no START, address NACK) is tried
+//  again after a backoff, I2C_BACKOFF_US then doubled each time, up to
+//  I2C_RETRIES times. One that failed on a data byte isn't, part of it may
+//  have been acted on (an LCD nibble strobed)
+// a device's health is a byte the driver keeps (0 to start with), the
+//  failed transactions in a row: after one the device is degraded and gets
+//  no retries, after I2C_OFFLINE_FAILS it is offline, and its transactions
+//  return -4 at once, without the bus, but for one in every I2C_PROBE_EVERY
+//  that goes out as a probe. Any that succeeds makes it healthy again
+#ifndef I2C_RETRIES
+#define I2C_RETRIES 2         // tries after the first
+#endif
+#ifndef I2C_BACKOFF_US
+#define I2C_BACKOFF_US 100    // wait before the first retry
+#endif
+#ifndef I2C_OFFLINE_FAILS
+#define I2C_OFFLINE_FAILS 4   // failed transactions in a row to go offline
+#endif
+#ifndef I2C_PROBE_EVERY
+#define I2C_PROBE_EVERY 32    // transactions of an offline device per probe
+#endif
+
+typedef enum
+{
+	I2C_Ok,
+	I2C_Degraded,   // failing, no retries
+	I2C_Offline     // failed I2C_OFFLINE_FAILS times, probed only
+} I2C_DevState;
+
+// one transaction on a bus, from I2C_BusStart to the STOP, returns 0 or
+//  the failed step's code (I2C_BusStart / I2C_BusWrite8 / I2C_BusRead8),
+//  and may return on a failure without the STOP
+typedef int (*I2C_Xfer)(I2C_Bus * pBus, unsigned char uc7Addr, void * pCtx);
+
+// called from the TWI interrupt for each byte of an I2C_WriteAsync
+typedef unsigned char (*I2C_Next)(void);
+
 // initialize the TWI bus for use
 int I2C_Init (unsigned long ulBusRate, I2C_BusRate sclRate);
 
+// set TWBR / TWPS for the SCL rate given to I2C_Init at a new bus (CPU)
+//  rate, only between transactions, software buses are retimed too
+// returns the SCL rate in Hz, the fastest there is at or below the one asked
+//  for (a slow clock may not reach it)
+unsigned long I2C_SetBusRate (unsigned long ulBusRate);
+
 // start a transaction with intent to read or write
+// waits for an interrupt driven write to finish first
 int I2C_Start (unsigned char uc7Addr, int bRead);
 
+// bring up a software bus on two pins of the port (&PORTx), both released
+// returns -1 if the pins aren't both high (no pull-ups, or a slave holding
+//  SDA), the bus is usable all the same once they are
+int I2C_SoftInit (I2C_Bus * pBus, volatile unsigned char * pPort, unsigned char ucSdaBit, unsigned char ucSclBit, unsigned long ulBusRate, I2C_BusRate sclRate);
+
+// I2C_Start / I2C_Write8 / I2C_Read8 on a bus, the same return codes
+//  (a stretch that doesn't end fails the step like a NACK)
+int I2C_BusStart (I2C_Bus * pBus, unsigned char uc7Addr, int bRead);
+int I2C_BusWrite8 (I2C_Bus * pBus, unsigned char ucData, int bStop);
+int I2C_BusRead8 (I2C_Bus * pBus, unsigned char * ucData, int bAck, int bStop);
+
+// copy of a bus's transfer counters
+void I2C_BusGetCounters (I2C_Bus * pBus, I2C_Counters * pCounters);
+
+// finish an open write transaction on the TWI from its interrupt: uiCount
+//  bytes, each from pNext (called in the ISR), then STOP. Returns at once,
+//  global interrupts must be on. A byte that isn't ACKed ends it with a
+//  STOP and counts an error
+int I2C_WriteAsync (I2C_Next pNext, unsigned int uiCount);
+
+// is an interrupt driven write still going?
+int I2C_Busy (void);
+
+// run pXfer as a transaction with the device at uc7Addr: a STOP after any
+//  failure, retries and backoff as above, the device's health updated
+//  (pucHealth, NULL for none)
+// returns pXfer's code, or -4 if the device is offline and not probed
+int I2C_Transact (I2C_Bus * pBus, unsigned char uc7Addr, unsigned char * pucHealth, I2C_Xfer pXfer, void * pCtx);
+
+// the state of a device from its health byte
+I2C_DevState I2C_State (unsigned char ucHealth);
+
+// close whatever is open on a bus with a STOP (or recover the TWI from a
+//  bus error), safe if nothing is
+void I2C_BusStop (I2C_Bus * pBus);
+
 // read an 8-bit device register (complete transaction)
 //int I2C_ReadRegister8 (unsigned char uc7Addr, unsigned char ucRegister, unsigned char * ucValue);
 
@@ -36,6 +165,9 @@ int I2C_Start (unsigned char uc7Addr, int bRead);
 // requires 128-byte buffer for results
 void I2C_Scan (unsigned char * results);
 
+// copy of the TWI transfer counters
+void I2C_GetCounters (I2C_Counters * pCounters);
+
 // private(ish)helper methods:
 // write a byte to an open transaction
 int I2C_Write8 (unsigned char ucData, int bStop);
@@ -2,12 +2,80 @@
 // Simon Walker, NAIT
 
 #include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include <util/delay_basic.h>
 #include "I2C.h"
 
-// not sure why there is a prescale greater than 1, as the bus rate
-//  won't typically be greater than 16MHz, and the I2C rate won't
-//  be slower than 100kHz, unless the user wants to run the I2C rate
-//  much slower than 100kHz?
+static I2C_Counters _I2C_Counters;
+
+// CPU clock, for software buses brought up later
+static unsigned long _ulI2C_BusRate = 0;
+
+// software buses, for clock changes
+static I2C_Bus * _pI2C_Soft = 0;
+
+// interrupt driven write: next byte source, bytes left after the one on the wire
+static volatile I2C_Next _pI2C_Next = 0;
+static unsigned int _uiI2C_Left = 0;
+
+// SCL rate asked for in I2C_Init, kept for clock changes
+static unsigned long _ulI2C_Scl = 100000;
+
+// a software bus bit is I2C_SOFT_CYCLES of I2C_SoftNine's instructions
+//  (counted off them, I2C_SOFT_LOW_CYCLES with SCL low, the rest high) and
+//  a delay of 3 cycles a pass in each half
+#define I2C_SOFT_CYCLES 34
+#define I2C_SOFT_LOW_CYCLES 18
+
+// delay passes for the SCL rate, rounded up so the bus is never faster
+//  than asked for, at least one a half, and SCL low at least the spec's
+//  4.7us (100kHz) / 1.3us (400kHz)
+// 16MHz: 400kHz is 1 + 1 passes, 40 cycles a bit, 100kHz is 21 + 21, 160
+static void I2C_SoftRetime (I2C_Bus * pBus)
+{
+	unsigned long ulBit = (_ulI2C_BusRate + pBus->ulScl - 1) / pBus->ulScl;
+	unsigned long ulLowNs = pBus->ulScl > 100000 ? 1300 : 4700;
+	unsigned long ulLowCycles = (_ulI2C_BusRate / 1000 * ulLowNs + 999999) / 1000000;
+	unsigned long ulPasses = ulBit > I2C_SOFT_CYCLES + 6 ? (ulBit - I2C_SOFT_CYCLES + 2) / 3 : 2;
+	unsigned long ulLow = (ulPasses + 1) / 2;
+	unsigned long ulHigh;
+
+	if (ulLowCycles > I2C_SOFT_LOW_CYCLES + 3 * ulLow)
+		ulLow = (ulLowCycles - I2C_SOFT_LOW_CYCLES + 2) / 3;
+	ulHigh = ulPasses > ulLow ? ulPasses - ulLow : 1;
+
+	pBus->ucLow = ulLow > 255 ? 255 : (unsigned char)ulLow;
+	pBus->ucHigh = ulHigh > 255 ? 255 : (unsigned char)ulHigh;
+}
+
+// SCL = bus rate / (16 + 2 * TWBR * 4^TWPS), the prescale only matters for
+//  a slow SCL from a fast bus, but it is there, so use it
+// TWBR is rounded up, so the bus is never faster than asked for
+unsigned long I2C_SetBusRate (unsigned long ulBusRate)
+{
+	unsigned long ulDiv = (ulBusRate + _ulI2C_Scl - 1) / _ulI2C_Scl;
+	unsigned long ulTwbr = ulDiv > 16 ? (ulDiv - 16 + 1) / 2 : 0;
+	unsigned char ucTwps = 0;
+
+	while (ulTwbr > 255 && ucTwps < 3)
+	{
+		ulTwbr = (ulTwbr + 3) / 4;
+		++ucTwps;
+	}
+	if (ulTwbr > 255)
+		ulTwbr = 255;
+
+	TWBR = (unsigned char)ulTwbr;
+	TWSR = ucTwps;   // the status bits are read only
+
+	_ulI2C_BusRate = ulBusRate;
+	for (I2C_Bus * pBus = _pI2C_Soft; pBus; pBus = pBus->pNext)
+		I2C_SoftRetime(pBus);
+
+	return ulBusRate / (16 + 2 * ulTwbr * (1UL << (2 * ucTwps)));
+}
+
 // return -1 if rate unreachable
 int I2C_Init (unsigned long ulBusRate, I2C_BusRate sclRate)
 {
@@ -15,32 +83,39 @@ int I2C_Init (unsigned long ulBusRate, I2C_BusRate sclRate)
 	// ensure power is on : TWI
 	PRR &= 0b01111111;
 
-	float fac = 0;
-
-  // precision here isn't necessary
 	switch (sclRate)
 	{
 		case I2CBus100:
-			fac = ((ulBusRate / 2.0f) / 100000.0f) - 8;
+			_ulI2C_Scl = 100000;
 			break;
 		case I2CBus400:
-			fac = ((ulBusRate / 2.0f) / 400000.0f) - 8;
+			_ulI2C_Scl = 400000;
 			break;
 	}
 
-	// fac must fit into 8 bits
-	if (fac < 1 || fac > 255)
+	// 16 bus clocks a bit at best (TWBR 0)
+	if (ulBusRate < 16 * _ulI2C_Scl)
 		return -1;
 
 	// set rate
-	TWBR = (unsigned char)fac;
+	(void)I2C_SetBusRate(ulBusRate);
 
 	// power on I2C to grab module pins
 	TWCR |= 0b00000100;
 
+	_I2C_Counters = (I2C_Counters){ 0, 0, 0 };
 	return 0;
 }
 
+void I2C_GetCounters (I2C_Counters * pCounters)
+{
+	// the TWI interrupt counts too
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		*pCounters = _I2C_Counters;
+	}
+}
+
 // assume 128-byte buffer provided for scan results
 void I2C_Scan (unsigned char * results)
 {
@@ -62,6 +137,14 @@ void I2C_Scan (unsigned char * results)
 
 int I2C_Start (unsigned char uc7Addr, int bRead)
 {
+	// an interrupt driven write, and its STOP, go out first
+	while (_pI2C_Next)
+		;
+	while (TWCR & 0x10)
+		;
+
+	++_I2C_Counters.ulStarts;
+
 	// send start
 	TWCR = 0b10100100;
 	
@@ -71,7 +154,10 @@ int I2C_Start (unsigned char uc7Addr, int bRead)
 
 	// ensure status says START sent (or restart?)
 	if (!((TWSR & 0b11111000) == 0x08 || (TWSR & 0b11111000) == 0x10))
+	{
+	  ++_I2C_Counters.uiErrors;
 	  return -1;
+	}
 
 	// now send address with read or write
 	if (bRead)
@@ -92,7 +178,10 @@ int I2C_Start (unsigned char uc7Addr, int bRead)
 
 		// look for ADDR+R sent with ACK
 		if ((TWSR & 0b11111000) != 0x40)
+		{
+		  ++_I2C_Counters.uiErrors;
 		  return -2;
+		}
 	}
 	else
 	{
@@ -112,7 +201,10 @@ int I2C_Start (unsigned char uc7Addr, int bRead)
 
 		// look for ADDR+W sent with ACK
 		if ((TWSR & 0b11111000) != 0x18)
+		{
+		  ++_I2C_Counters.uiErrors;
 		  return -2;
+		}
 	}
 
 	return 0;
@@ -135,14 +227,21 @@ int I2C_Read8 (unsigned char *ucData, int bAck, int bStop)
 	{
 		// look for data received, ack returned
 		if ((TWSR & 0b11111000) != 0x50)
+		{
+		  ++_I2C_Counters.uiErrors;
 		  return -3;
+		}
 	}
 	else
 	{
 		// look for data received, ack not returned
 		if ((TWSR & 0b11111000) != 0x58)
+		{
+		  ++_I2C_Counters.uiErrors;
 		  return -3;
+		}
 	}
+	++_I2C_Counters.ulBytes;
 
 	// read the data byte
 	*ucData = TWDR;
@@ -176,7 +275,11 @@ int I2C_Write8 (unsigned char ucData, int bStop)
 
 	// look for data sent with ACK
 	if ((TWSR & 0b11111000) != 0x28)
+	{
+	  ++_I2C_Counters.uiErrors;
 	  return -3;
+	}
+	++_I2C_Counters.ulBytes;
 	
 	// if stop requested, send it
 	if (bStop)
@@ -192,3 +295,381 @@ int I2C_Write8 (unsigned char ucData, int bStop)
 	return 0;
 }
 
+// assumes a write transaction is open
+int I2C_WriteAsync (I2C_Next pNext, unsigned int uiCount)
+{
+	if (!uiCount)
+		return 0;
+
+	_uiI2C_Left = uiCount - 1;
+	_pI2C_Next = pNext;
+
+	// first byte out here, the rest from the ISR
+	TWDR = pNext();
+
+	// clear TWINT, keep TWI enabled, interrupt on
+	TWCR = 0b10000101;
+	return 0;
+}
+
+int I2C_Busy (void)
+{
+	return _pI2C_Next != 0;
+}
+
+// a byte of an interrupt driven write is done
+ISR(TWI_vect)
+{
+	// look for data sent with ACK
+	if ((TWSR & 0b11111000) != 0x28)
+	{
+		++_I2C_Counters.uiErrors;
+		_uiI2C_Left = 0;
+	}
+	else
+		++_I2C_Counters.ulBytes;
+
+	if (!_uiI2C_Left)
+	{
+		// send STOP, interrupt off, I2C_Start waits for it to complete
+		TWCR = 0b10010100;
+		_pI2C_Next = 0;
+		return;
+	}
+
+	--_uiI2C_Left;
+	TWDR = _pI2C_Next();
+	TWCR = 0b10000101;
+}
+
+// software bus, open drain: DDR bit set drives the line low, clear
+//  releases it to the pull-up (the PORT bit is left 0)
+#define I2C_SOFT_PIN(b) (*((b)->pPort - 2))
+#define I2C_SOFT_DDR(b) (*((b)->pPort - 1))
+
+static inline void I2C_SoftLow (I2C_Bus * pBus, unsigned char ucMask)
+{
+	I2C_SOFT_DDR(pBus) |= ucMask;
+}
+
+static inline void I2C_SoftRelease (I2C_Bus * pBus, unsigned char ucMask)
+{
+	I2C_SOFT_DDR(pBus) &= ~ucMask;
+}
+
+// start and stop set-up / hold, the low half's delay (the longer)
+static inline void I2C_SoftHalf (I2C_Bus * pBus)
+{
+	_delay_loop_1(pBus->ucLow);
+}
+
+// release SCL and wait out a stretch, -1 if it never comes up
+static int I2C_SoftSclHigh (I2C_Bus * pBus)
+{
+	unsigned int uiPolls = I2C_SOFT_STRETCH;
+
+	I2C_SoftRelease(pBus, pBus->ucScl);
+	while (!(I2C_SOFT_PIN(pBus) & pBus->ucScl))
+	{
+		if (!--uiPolls)
+			return -1;
+	}
+	return 0;
+}
+
+// nine bits, SCL low on entry and exit: uiOut from bit 15 down (a 1
+//  releases SDA, to read it), returns SDA as sampled at each, the first in
+//  bit 8, or -1 if a stretch never ends
+// a bit is I2C_SOFT_CYCLES + 3 * (ucLow + ucHigh), the cycles of each
+//  instruction are in its comment: SCL low from the end of one std to the
+//  next is 18 + 3 * ucLow, high 16 + 3 * ucHigh, with SCL seen high at once
+//  (the rise time, a stretch and interrupts only make a bit longer)
+static int I2C_SoftNine (I2C_Bus * pBus, unsigned int uiOut)
+{
+	volatile unsigned char * pPin = &I2C_SOFT_PIN(pBus);
+	unsigned char ucSda = pBus->ucSda;
+	unsigned char ucScl = pBus->ucScl;
+	unsigned char ucNotScl = ~pBus->ucScl;
+	unsigned char ucLow = pBus->ucLow;
+	unsigned char ucHigh = pBus->ucHigh;
+	unsigned char ucBits = 9;
+	unsigned int uiIn = 0;
+	unsigned int uiPolls;
+	unsigned char ucT;
+	unsigned char ucC;
+
+	// DDR is the register above PIN, a set bit pulls the line low
+	__asm volatile (
+		"1:	ldd %[t], %a[pin]+1\n\t"     // 2  SDA low, released for a 1
+		"	or %[t], %[sda]\n\t"         // 1
+		"	sbrc %B[out], 7\n\t"         // 1 / 2
+		"	eor %[t], %[sda]\n\t"        // 1
+		"	std %a[pin]+1, %[t]\n\t"     // 2
+		"	lsl %A[out]\n\t"             // 1
+		"	rol %B[out]\n\t"             // 1
+		"	movw %[polls], %[stretch]\n\t" // 1
+		"	mov %[c], %[lo]\n\t"         // 3 * lo with the loop
+		"2:	dec %[c]\n\t"
+		"	brne 2b\n\t"
+		"	ldd %[t], %a[pin]+1\n\t"     // 2  SCL released
+		"	and %[t], %[nscl]\n\t"       // 1
+		"	std %a[pin]+1, %[t]\n\t"     // 2
+		"3:	ld %[t], %a[pin]\n\t"        // 2  until it is seen high
+		"	and %[t], %[scl]\n\t"        // 1
+		"	brne 4f\n\t"                 // 2
+		"	sbiw %[polls], 1\n\t"
+		"	brne 3b\n\t"
+		"	rjmp 6f\n\t"                 // polls 0, never came up
+		"4:	mov %[c], %[hi]\n\t"         // 3 * hi with the loop
+		"5:	dec %[c]\n\t"
+		"	brne 5b\n\t"
+		"	ld %[t], %a[pin]\n\t"        // 2  sample SDA
+		"	and %[t], %[sda]\n\t"        // 1
+		"	cp __zero_reg__, %[t]\n\t"   // 1  carry if high
+		"	rol %A[in]\n\t"              // 1
+		"	rol %B[in]\n\t"              // 1
+		"	ldd %[t], %a[pin]+1\n\t"     // 2  SCL low
+		"	or %[t], %[scl]\n\t"         // 1
+		"	std %a[pin]+1, %[t]\n\t"     // 2
+		"	dec %[bits]\n\t"             // 1
+		"	brne 1b\n\t"                 // 2
+		"6:\n\t"
+		: [out] "+r" (uiOut), [in] "+r" (uiIn), [bits] "+r" (ucBits),
+		  [polls] "=&w" (uiPolls), [t] "=&r" (ucT), [c] "=&r" (ucC)
+		: [pin] "b" (pPin), [sda] "r" (ucSda), [scl] "r" (ucScl),
+		  [nscl] "r" (ucNotScl), [lo] "r" (ucLow), [hi] "r" (ucHigh),
+		  [stretch] "r" ((unsigned int)I2C_SOFT_STRETCH)
+		: "memory");
+
+	if (!uiPolls)
+		return -1;
+	return uiIn & 0x1FF;
+}
+
+// eight bits out, MSB first, then the slave's ACK bit: 0 ACK, 1 NACK, -1
+static int I2C_SoftByte (I2C_Bus * pBus, unsigned char ucData)
+{
+	int iNine = I2C_SoftNine(pBus, (unsigned int)ucData << 8 | 0x80);
+
+	return iNine < 0 ? -1 : (iNine & 1);
+}
+
+static void I2C_SoftStop (I2C_Bus * pBus)
+{
+	// SDA rises while SCL is high
+	I2C_SoftLow(pBus, pBus->ucSda);
+	I2C_SoftHalf(pBus);
+	(void)I2C_SoftSclHigh(pBus);
+	I2C_SoftHalf(pBus);
+	I2C_SoftRelease(pBus, pBus->ucSda);
+	I2C_SoftHalf(pBus);
+	pBus->ucOpen = 0;
+}
+
+int I2C_SoftInit (I2C_Bus * pBus, volatile unsigned char * pPort, unsigned char ucSdaBit, unsigned char ucSclBit, unsigned long ulBusRate, I2C_BusRate sclRate)
+{
+	pBus->pPort = pPort;
+	pBus->ucSda = 1 << ucSdaBit;
+	pBus->ucScl = 1 << ucSclBit;
+	pBus->ucOpen = 0;
+	pBus->ulScl = sclRate == I2CBus400 ? 400000 : 100000;
+	pBus->Counters = (I2C_Counters){ 0, 0, 0 };
+
+	// both released, no pull-ups of our own
+	*pPort &= ~(pBus->ucSda | pBus->ucScl);
+	I2C_SoftRelease(pBus, pBus->ucSda | pBus->ucScl);
+
+	_ulI2C_BusRate = ulBusRate;
+	I2C_SoftRetime(pBus);
+
+	// once on the list
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		I2C_Bus * pAt = _pI2C_Soft;
+
+		while (pAt && pAt != pBus)
+			pAt = pAt->pNext;
+		if (!pAt)
+		{
+			pBus->pNext = _pI2C_Soft;
+			_pI2C_Soft = pBus;
+		}
+	}
+
+	if ((I2C_SOFT_PIN(pBus) & (pBus->ucSda | pBus->ucScl)) != (pBus->ucSda | pBus->ucScl))
+		return -1;
+	return 0;
+}
+
+int I2C_BusStart (I2C_Bus * pBus, unsigned char uc7Addr, int bRead)
+{
+	int iAck;
+
+	if (pBus == I2C_HW)
+		return I2C_Start(uc7Addr, bRead);
+
+	++pBus->Counters.ulStarts;
+
+	// a restart takes both lines back up first
+	if (pBus->ucOpen)
+	{
+		I2C_SoftRelease(pBus, pBus->ucSda);
+		I2C_SoftHalf(pBus);
+		if (I2C_SoftSclHigh(pBus))
+		{
+			++pBus->Counters.uiErrors;
+			return -1;
+		}
+		I2C_SoftHalf(pBus);
+	}
+
+	// START, SDA falls while SCL is high
+	if (!(I2C_SOFT_PIN(pBus) & pBus->ucSda))
+	{
+		++pBus->Counters.uiErrors;
+		return -1;
+	}
+	I2C_SoftLow(pBus, pBus->ucSda);
+	I2C_SoftHalf(pBus);
+	I2C_SoftLow(pBus, pBus->ucScl);
+	pBus->ucOpen = 1;
+
+	// address with read or write, look for the ACK
+	iAck = I2C_SoftByte(pBus, (uc7Addr << 1) | (bRead ? 0x01 : 0x00));
+	if (iAck)
+	{
+		++pBus->Counters.uiErrors;
+		return iAck < 0 ? -1 : -2;
+	}
+	return 0;
+}
+
+int I2C_BusWrite8 (I2C_Bus * pBus, unsigned char ucData, int bStop)
+{
+	if (pBus == I2C_HW)
+		return I2C_Write8(ucData, bStop);
+
+	// look for data sent with ACK
+	if (I2C_SoftByte(pBus, ucData))
+	{
+		++pBus->Counters.uiErrors;
+		return -3;
+	}
+	++pBus->Counters.ulBytes;
+
+	if (bStop)
+		I2C_SoftStop(pBus);
+	return 0;
+}
+
+int I2C_BusRead8 (I2C_Bus * pBus, unsigned char * ucData, int bAck, int bStop)
+{
+	unsigned char ucByte;
+	int iNine;
+
+	if (pBus == I2C_HW)
+		return I2C_Read8(ucData, bAck, bStop);
+
+	// SDA released for the slave to drive, then ACK for more, NACK for the last
+	iNine = I2C_SoftNine(pBus, bAck ? 0xFF00 : 0xFF80);
+	if (iNine < 0)
+	{
+		++pBus->Counters.uiErrors;
+		return -3;
+	}
+	ucByte = iNine >> 1;
+	++pBus->Counters.ulBytes;
+	*ucData = ucByte;
+
+	if (bStop)
+		I2C_SoftStop(pBus);
+	return 0;
+}
+
+void I2C_BusGetCounters (I2C_Bus * pBus, I2C_Counters * pCounters)
+{
+	if (pBus == I2C_HW)
+		I2C_GetCounters(pCounters);
+	else
+		*pCounters = pBus->Counters;
+}
+
+void I2C_BusStop (I2C_Bus * pBus)
+{
+	if (pBus == I2C_HW)
+	{
+		// as master a STOP, after a bus error it releases the lines
+		TWCR = 0b10010100;
+
+		// wait for stop to automatically clear (stop completed)
+		while (TWCR & 0x10)
+			;
+		return;
+	}
+
+	// SDA could be anywhere, the stop takes it low first
+	if (pBus->ucOpen)
+		I2C_SoftStop(pBus);
+}
+
+// wait uiUs at the bus (CPU) rate, _delay_loop_2 passes are 4 cycles
+static void I2C_Backoff (unsigned int uiUs)
+{
+	unsigned long ulPasses = _ulI2C_BusRate / 1000 * uiUs / 4000;
+
+	for (; ulPasses > 0xFFFF; ulPasses -= 0x10000)
+		_delay_loop_2(0);
+	if (ulPasses)
+		_delay_loop_2((unsigned int)ulPasses);
+}
+
+I2C_DevState I2C_State (unsigned char ucHealth)
+{
+	if (!ucHealth)
+		return I2C_Ok;
+	return ucHealth < I2C_OFFLINE_FAILS ? I2C_Degraded : I2C_Offline;
+}
+
+int I2C_Transact (I2C_Bus * pBus, unsigned char uc7Addr, unsigned char * pucHealth, I2C_Xfer pXfer, void * pCtx)
+{
+	unsigned char ucHealth = pucHealth ? *pucHealth : 0;
+	unsigned char ucTries = 1 + I2C_RETRIES;
+	unsigned int uiBackoff = I2C_BACKOFF_US;
+	int iRet;
+
+	if (ucHealth >= I2C_OFFLINE_FAILS)
+	{
+		// offline, counts round to the next probe (back at I2C_OFFLINE_FAILS)
+		if (++ucHealth >= I2C_OFFLINE_FAILS + I2C_PROBE_EVERY)
+			ucHealth = I2C_OFFLINE_FAILS;
+		*pucHealth = ucHealth;
+		if (ucHealth != I2C_OFFLINE_FAILS)
+			return -4;
+		ucTries = 1;
+	}
+	else if (ucHealth)
+		ucTries = 1;
+
+	for (;;)
+	{
+		iRet = pXfer(pBus, uc7Addr, pCtx);
+		if (!iRet)
+			break;
+
+		// whatever failed, the bus is let go
+		I2C_BusStop(pBus);
+		if (iRet == -3 || !--ucTries)
+			break;
+		I2C_Backoff(uiBackoff);
+		uiBackoff <<= 1;
+	}
+
+	if (pucHealth)
+	{
+		if (!iRet)
+			*pucHealth = 0;
+		else if (*pucHealth < I2C_OFFLINE_FAILS)
+			++*pucHealth;
+	}
+	return iRet;
+}
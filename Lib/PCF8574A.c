@@ -1,9 +1,8 @@
 // implementation for PCF8574A - Common Port Expander for LCD Backpack in Arduino World
 // Simon Walker, NAIT
 
-// this will need to be defined to generate the correct
-//  delays in the init routine
-#define F_CPU 2E6
+// delays come from the clock service (clock.h), so they hold at any
+//  CPU clock
 
 // delay between steps of initialization
 #define LCD_INIT_DELAY_MS 100
@@ -11,8 +10,12 @@
 // delay for strobe of E
 #define LCD_CMD_DELAY_uS 10
 
+// delay after each step of a resync (over the 4.1ms of the first)
+#define LCD_SYNC_DELAY_MS 5
+
 #include <avr/io.h>
-#include <util/delay.h>
+#include <string.h>
+#include "clock.h"
 #include "I2C.h"
 #include "PCF8574A.h"
 
@@ -51,37 +54,83 @@ union
 	} Bits;
 } LCD_PORT;
 
+// the LCD's bus, the TWI unless LCD_SetBus moved it
+static I2C_Bus * _pLCD_Bus = I2C_HW;
+
+// failed transactions in a row (I2C_Transact)
+static unsigned char _ucLCD_Health = 0;
+
+// the controller may be out of step with us (a character cut short, a
+//  failed init, back from offline), resync it before the next write, and
+//  the (re)syncs done so far
+static unsigned char _ucLCD_Resync = 1;
+static unsigned char _ucLCD_Syncs = 0;
+
+// display control as last set, a resync puts it back
+static unsigned char _ucLCD_Display = 0x0c;
+
+// one transaction of characters (RS 1) or an instruction (RS 0)
+typedef struct LCD_Run
+{
+	unsigned char RS;
+	const char * pChars;
+	unsigned int uiCount;
+} LCD_Run;
+
+void LCD_SetBus (I2C_Bus * pBus)
+{
+	_pLCD_Bus = pBus;
+}
+
+int LCD_Health (void)
+{
+	return I2C_State(_ucLCD_Health);
+}
+
+unsigned char LCD_Syncs (void)
+{
+	return _ucLCD_Syncs;
+}
+
 // private helpers
-int PCF8574A_Write (unsigned char ucData)
+static int PCF8574A_WriteXfer (I2C_Bus * pBus, unsigned char uc7Addr, void * pCtx)
 {
-	if (I2C_Start(PCF8574A_ADDR, 0))
-	return -1;
+	int iRet = I2C_BusStart(pBus, uc7Addr, I2C_WRITE);
 
-	if (I2C_Write8(ucData, 1))
-	return -2;
-	
-	return 0;
+	if (iRet)
+		return iRet;
+
+	return I2C_BusWrite8(pBus, *(unsigned char *)pCtx, I2C_STOP);
 }
 
-int PCF8574A_Read (unsigned char * Target)
+static int PCF8574A_ReadXfer (I2C_Bus * pBus, unsigned char uc7Addr, void * pCtx)
 {
-	if (I2C_Start(PCF8574A_ADDR, 1))
-	return -1;
+	int iRet = I2C_BusStart(pBus, uc7Addr, I2C_READ);
 
-	if (I2C_Read8(Target, 0, 1))
-	return -2;
-	
-	return 0;
+	if (iRet)
+		return iRet;
+
+	return I2C_BusRead8(pBus, pCtx, I2C_NACK, I2C_STOP);
+}
+
+int PCF8574A_Write (unsigned char ucData)
+{
+	return I2C_Transact(_pLCD_Bus, PCF8574A_ADDR, &_ucLCD_Health, PCF8574A_WriteXfer, &ucData);
+}
+
+int PCF8574A_Read (unsigned char * Target)
+{
+	return I2C_Transact(_pLCD_Bus, PCF8574A_ADDR, &_ucLCD_Health, PCF8574A_ReadXfer, Target);
 }
 
 void LCD_InitDelay ()
 {
-  _delay_ms(LCD_INIT_DELAY_MS);
+  Clock_DelayMs(LCD_INIT_DELAY_MS);
 }
 
 void LCD_CmdDelay ()
 {
-  _delay_us(LCD_CMD_DELAY_uS);
+  Clock_DelayUs(LCD_CMD_DELAY_uS);
 }
 
 int LCD_WritePort ()
@@ -151,123 +200,187 @@ int LCD_Busy ()
 	return 0;
 }
 
-int LCD_Inst (unsigned char Value)
+// both nibbles of a byte into an open write transaction, E strobed by
+//  consecutive port writes: a byte on the bus (9 bit times, 90us at
+//  100kHz) is far longer than the E pulse, setup and hold times, and the
+//  four of them are longer than the 37us the controller takes on any
+//  instruction but clear / home, so there is no busy check in between
+static int LCD_Nibbles (I2C_Bus * pBus, unsigned char Value, int bStop)
 {
-	LCD_Busy();
-	
-	// switch to 8-bit interface
 	LCD_PORT.Bits.Data = Value >> 4;
 	LCD_PORT.Bits.E = 1;
-	LCD_PORT.Bits.RW = 0;
-	LCD_PORT.Bits.RS = 0;
-	if (LCD_WritePort())
-		return -1;
-	LCD_CmdDelay();
+	if (I2C_BusWrite8(pBus, LCD_PORT.Byte, 0))
+		return -3;
 	LCD_PORT.Bits.E = 0;
-	if (LCD_WritePort())
-		return -1;
-	LCD_CmdDelay();
-	
+	if (I2C_BusWrite8(pBus, LCD_PORT.Byte, 0))
+		return -3;
+
 	LCD_PORT.Bits.Data = Value & 0x0f;
 	LCD_PORT.Bits.E = 1;
-	if (LCD_WritePort())
-		return -1;
-	LCD_CmdDelay();
+	if (I2C_BusWrite8(pBus, LCD_PORT.Byte, 0))
+		return -3;
 	LCD_PORT.Bits.E = 0;
-	if (LCD_WritePort())
+	if (I2C_BusWrite8(pBus, LCD_PORT.Byte, bStop))
+		return -3;
+
+	return 0;
+}
+
+// a write transaction for instructions (RS 0) or data (RS 1), a character
+//  that fails part way isn't repeated (I2C_Transact), the controller is a
+//  nibble out then and gets resynced before the next write
+static int LCD_RunXfer (I2C_Bus * pBus, unsigned char uc7Addr, void * pCtx)
+{
+	LCD_Run * pRun = pCtx;
+	const char * pChars = pRun->pChars;
+	int iRet;
+
+	LCD_PORT.Bits.RW = 0;
+	LCD_PORT.Bits.RS = pRun->RS;
+	LCD_PORT.Bits.BL = 1;
+	iRet = I2C_BusStart(pBus, uc7Addr, I2C_WRITE);
+	if (iRet)
+		return iRet;
+
+	for (unsigned int uiLeft = pRun->uiCount; uiLeft; --uiLeft, ++pChars)
+	{
+		iRet = LCD_Nibbles(pBus, *pChars, uiLeft == 1);
+		if (iRet)
+			return iRet;
+	}
+	return 0;
+}
+
+static int LCD_Put (unsigned char RS, const char * pChars, unsigned int uiCount)
+{
+	LCD_Run run = { RS, pChars, uiCount };
+	int iRet;
+
+	if (!uiCount)
+		return 0;
+	iRet = I2C_Transact(_pLCD_Bus, PCF8574A_ADDR, &_ucLCD_Health, LCD_RunXfer, &run);
+	if (iRet == -3)
+		_ucLCD_Resync = 1;
+	return iRet;
+}
+
+static int LCD_PutInst (unsigned char Value)
+{
+	// one transaction
+	if (LCD_Put(0, (const char *)&Value, 1))
 		return -1;
-	LCD_CmdDelay();
+
+	// clear and home take 1.52ms, wait them out here so nothing else has to
+	if (Value == 0x01 || (Value & 0xFE) == 0x02)
+	{
+		if (LCD_Busy())
+			return -1;
+	}
 
 	return 0;
 }
 
-int LCD_Data (unsigned char Value)
+// three 8-bit function sets get the controller back to 8-bit from any
+//  state (8-bit, or either nibble of 4-bit), then 4-bit and the setup,
+//  and the display is cleared, whatever was on it is suspect
+static int LCD_Sync (unsigned int uiDelayMs)
 {
-	LCD_Busy();
-	
-	// switch to 8-bit interface
-	LCD_PORT.Bits.Data = Value >> 4;
-	LCD_PORT.Bits.E = 1;
+	_ucLCD_Resync = 1; // until all of it has gone through
+
 	LCD_PORT.Bits.RW = 0;
-	LCD_PORT.Bits.RS = 1;
-	if (LCD_WritePort())
+	LCD_PORT.Bits.RS = 0;
+	LCD_PORT.Bits.BL = 1;
+	for (int i = 0; i < 4; ++i)
+	{
+		// switch to 8-bit interface three times, then to 4-bit
+		LCD_PORT.Bits.Data = i < 3 ? 0x03 : 0x02;
+		LCD_PORT.Bits.E = 1;
+		if (LCD_WritePort())
+			return -1;
+		LCD_PORT.Bits.E = 0;
+		if (LCD_WritePort())
+			return -1;
+		Clock_DelayMs(uiDelayMs);
+	}
+
+	if (LCD_PutInst(0x28)) // 4-bit interface, 2 lines, 5x7 characters
 		return -1;
-	LCD_CmdDelay();
-	LCD_PORT.Bits.E = 0;
-	if (LCD_WritePort())
+	if (LCD_PutInst(_ucLCD_Display)) // display control as last set
 		return -1;
-	LCD_CmdDelay();
-	
-	LCD_PORT.Bits.Data = Value & 0x0f;
-	LCD_PORT.Bits.E = 1;
-	if (LCD_WritePort())
+	if (LCD_PutInst(0x06)) // increment address on write, no shift
 		return -1;
-	LCD_CmdDelay();
-	LCD_PORT.Bits.E = 0;
-	if (LCD_WritePort())
+	if (LCD_PutInst(0x02)) // home
+		return -1;
+	if (LCD_PutInst(0x01)) // clear
+		return -1;
+
+	_ucLCD_Resync = 0;
+	++_ucLCD_Syncs;
+	return 0;
+}
+
+// resync first when it's due, an offline LCD may have lost power, so one
+//  that comes back is resynced too (the resync's first write is the probe)
+static int LCD_Ready (void)
+{
+	if (I2C_State(_ucLCD_Health) == I2C_Offline)
+		_ucLCD_Resync = 1;
+	if (_ucLCD_Resync && LCD_Sync(LCD_SYNC_DELAY_MS))
+		return -1;
+	return 0;
+}
+
+static int LCD_Send (unsigned char RS, const char * pChars, unsigned int uiCount)
+{
+	if (LCD_Ready())
+		return -1;
+	return LCD_Put(RS, pChars, uiCount);
+}
+
+int LCD_Inst (unsigned char Value)
+{
+	if (LCD_Ready())
+		return -1;
+	return LCD_PutInst(Value);
+}
+
+int LCD_Data (unsigned char Value)
+{
+	// one transaction
+	if (LCD_Send(1, (const char *)&Value, 1))
 		return -1;
-	LCD_CmdDelay();
 
 	return 0;
 }
 
 int LCD_Init (unsigned long cpufreq)
 {
-  // save frequency for avr delay function
+  // cpufreq isn't needed any more, the delays follow Clock_Hz
  
 	// all high but E
 	LCD_PORT.Byte = 0b11111011;
 	if (LCD_WritePort())
-		return -1;
-
-	// delay to wait for E to unclog
-	LCD_InitDelay();
-
-	for (int i = 0; i < 2; ++i)
 	{
-		// switch to 8-bit interface
-		LCD_PORT.Bits.Data = 0x03;
-		LCD_PORT.Bits.E = 1;
-		LCD_PORT.Bits.RW = 0;
-		LCD_PORT.Bits.RS = 0;
-		if (LCD_WritePort())
-			return -1;
-		LCD_InitDelay();
-		LCD_PORT.Bits.E = 0;
-		if (LCD_WritePort())
-			return -1;	
-		LCD_InitDelay();
+		_ucLCD_Resync = 1;
+		return -1;
 	}
 
-	// switch to 4-bit interface
-	LCD_PORT.Bits.Data = 0x02;
-	LCD_PORT.Bits.E = 1;
-	if (LCD_WritePort())
-	  return -1;
-	LCD_InitDelay();
-	LCD_PORT.Bits.E = 0;
-	if (LCD_WritePort())
-	  return -1;
+	// delay to wait for E to unclog
 	LCD_InitDelay();
 
-	LCD_Inst(0x28); // 4-bit interface, 2 lines, 5x7 characters
-	LCD_Inst(0x0c); // display on, blink and cursor off
-	LCD_Inst(0x06); // increment address on write, no shift
-	LCD_Inst(0x02); // home
- 	LCD_Inst(0x01); // clear
-
-	return 0;
+	// a failed init leaves the resync due, the next write tries again
+	return LCD_Sync(LCD_INIT_DELAY_MS);
 }
 
 // set addr in A to LCD
-void LCD_Addr (unsigned char addr)
+int LCD_Addr (unsigned char addr)
 {
 	addr |= 0x80;
-	LCD_Inst (addr);
+	return LCD_Inst (addr);
 }
 
 // set addr in A to LCD
-void LCD_AddrXY (unsigned char ix, unsigned char iy)
+int LCD_AddrXY (unsigned char ix, unsigned char iy)
 {
 	unsigned char phoffset = 0;
 	
@@ -279,9 +392,9 @@ void LCD_AddrXY (unsigned char ix, unsigned char iy)
 	
 	// range check
 	if (iy > 3)
-		return;
+		return -1;
 	if (ix > 19)
-		return;
+		return -1;
 	
 	// calculate address offset
 	if (!iy)
@@ -297,37 +410,44 @@ void LCD_AddrXY (unsigned char ix, unsigned char iy)
 	
 	phoffset |= 0x80; // make into dd addr command
 	
-	LCD_Inst (phoffset);
+	return LCD_Inst (phoffset);
 }
 
-void LCD_String (char * straddr)
+// the whole string is one transaction, 4 port writes a character
+int LCD_String (char * straddr)
 {
-	for (; *straddr; ++straddr)
-		LCD_Data (*straddr);
+	return LCD_Send(1, straddr, strlen(straddr)) ? -1 : 0;
+}
+
+// a run of characters, not terminated, as one transaction
+int LCD_Chars (const char * pChars, unsigned char ucCount)
+{
+	return LCD_Send(1, pChars, ucCount) ? -1 : 0;
 }
 
 // start the string at X/Y
-void LCD_StringXY (unsigned char ix, unsigned char iy, char * straddr)
+int LCD_StringXY (unsigned char ix, unsigned char iy, char * straddr)
 {
 	// range check
 	if (iy > 3)
-	return;
+	return -1;
 	if (ix > 19)
-	return;
+	return -1;
 
-	LCD_AddrXY (ix, iy);
+	if (LCD_AddrXY (ix, iy))
+		return -1;
 	
 	// show the string...
-	LCD_String (straddr);
+	return LCD_String (straddr);
 }
 
 // clear the display
-void LCD_Clear (void)
+int LCD_Clear (void)
 {
-	LCD_Inst (0x01);
+	return LCD_Inst (0x01);
 }
 
-void LCD_DispControl (char curon, char blinkon, char dispon)
+int LCD_DispControl (char curon, char blinkon, char dispon)
 {
 	unsigned char bval = 0b00001000; // command = display control
 	
@@ -338,5 +458,6 @@ void LCD_DispControl (char curon, char blinkon, char dispon)
 	if (blinkon)
 		bval |= 0x01;         // add blink
 	
-	LCD_Inst (bval);
+	_ucLCD_Display = bval;
+	return LCD_Inst (bval);
 }
@@ -2,14 +2,38 @@
 // Simon Walker, NAIT
 // Revision History:
 // March 22 2022 - Initial Build
+// Oct 2026 - One I2C transaction per instruction / character (and one for a
+//             whole string), no busy polling except after clear and home
+// Oct 2026 - Delays from the clock service (clock.h) instead of a fixed F_CPU
+// Oct 2026 - LCD_Chars, a counted run of characters (console.h shadow flush)
+// Oct 2026 - LCD_SetBus, the LCD can sit on a software I2C bus (I2C.h)
+// Oct 2026 - Every transfer through I2C_Transact (STOP on failure, retries,
+//             health in LCD_Health), all calls return 0 or -1
+// Oct 2026 - A controller that may be out of step (a character cut short,
+//             a failed init, back from offline) is resynced before the
+//             next write, counted in LCD_Syncs
+
+struct I2C_Bus;
+
+// the bus the LCD is on (I2C_HW, the TWI, to start with), before LCD_Init
+void LCD_SetBus (struct I2C_Bus * pBus);
 
 int LCD_Init (unsigned long cpufreq);
 //int PCF8574A_Write (unsigned char ucData);
 //int PCF8574A_Read (unsigned char * Target);
 
-void LCD_Clear (void);
-void LCD_Addr (unsigned char addr);
-void LCD_AddrXY (unsigned char ix, unsigned char iy);
-void LCD_String (char * straddr);
-void LCD_StringXY (unsigned char ix, unsigned char iy, char * straddr);
-void LCD_DispControl (char curon, char blinkon, char dispon);
\ No newline at end of file
+// I2C_Ok, I2C_Degraded or I2C_Offline (I2C.h), an offline LCD costs
+//  nothing on the bus but a probe now and then
+int LCD_Health (void);
+
+// (re)initializations of the controller so far, each clears the display, a
+//  change means whatever was on it has to be written again
+unsigned char LCD_Syncs (void);
+
+int LCD_Clear (void);
+int LCD_Addr (unsigned char addr);
+int LCD_AddrXY (unsigned char ix, unsigned char iy);
+int LCD_String (char * straddr);
+int LCD_Chars (const char * pChars, unsigned char ucCount);
+int LCD_StringXY (unsigned char ix, unsigned char iy, char * straddr);
+int LCD_DispControl (char curon, char blinkon, char dispon);
\ No newline at end of file
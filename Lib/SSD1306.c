@@ -5,6 +5,24 @@
 // Feb 13 2023 - Adjusted directives to include 128x32 and 128x64 implementations
 //               Needs to be adjusted to make this easier to maintain, but also
 //                require appropriate backbuffer storage.
+// Oct 2026    - dirty tracking is now a column span per page, so renders only
+//                push the columns that changed
+//             - added SSD1306_Blit for PROGMEM bitmaps at any pixel offset
+//             - added flash font descriptors and pixel positioned text
+//                (SSD1306_FontStringXY), _CharMap is now SSD1306_Font5x7
+//             - one implementation for all geometries, working on the display
+//                selected with SSD1306_Select (see SSD1306_DISPLAY), so
+//                several panels can share one firmware image
+//             - init and render window commands go out as one command stream
+//                transaction each (SSD1306_CommandList), display now runs in
+//                horizontal addressing mode
+//             - transport layer under the command/data helpers, with a
+//                4-wire hardware SPI backend (_SSD1306_SPI) next to the TWI
+//             - I2C displays on any bus handle (software buses), the TWI
+//                render window can go out from the TWI interrupt
+//             - every I2C transfer is an I2C_Transact transaction (STOP on
+//                failure, retries, health per display), the management
+//                calls return 0 or -1, a failed render leaves its window dirty
 
 // SSD1306 - OLED Display : 7-bit Address 0x3C as _SSD1306_ADDRESS
 // this library has only been tested with 128 x 64 SSD1306 devices
@@ -16,23 +34,56 @@
 #include <avr/io.h>
 #include <stdlib.h>
 #include <math.h>
+#ifdef _SSD1306_SPI
+#include <avr/interrupt.h>
+#endif
 
-// the back-buffer for the OLED display
-// bits in here map to pixels on the display
-// no direct writes to display memory should occur
-// setting bits via functions will dirty flags for redraw
-#ifdef _SSD1306_DisplaySize128x64
-static unsigned char _DispBuff [8 * 128] = { 0 };
+#ifdef _SSD1306_I2C_ASYNC
+// TWI render window being streamed: row, columns [Lo, End), next column
+static unsigned char * _pTwiRow;
+static unsigned char _ucTwiCol, _ucTwiLo, _ucTwiEnd, _ucTwiWidth;
+
+// next byte of the window, called from the TWI interrupt
+static unsigned char SSD1306_TwiNext (void)
+{
+  if (_ucTwiCol >= _ucTwiEnd)
+  {
+    _pTwiRow += _ucTwiWidth;
+    _ucTwiCol = _ucTwiLo;
+  }
+  return _pTwiRow[_ucTwiCol++];
+}
+#endif
 
-// dirty flags for render management (vertical banks)
-static unsigned char _DispDirty [8] = { 0 };
+// geometry of a display instance
+// when only one geometry is built these are constants, so the compiler
+//  can fold all of the buffer index math
+#if defined(_SSD1306_MULTI_GEOMETRY)
+#define _SSD1306_WIDTH(d) ((d)->Width)
+#define _SSD1306_PAGES(d) ((d)->Height >> 3)
+#elif defined(_SSD1306_DisplaySize128x64)
+#define _SSD1306_WIDTH(d) 128
+#define _SSD1306_PAGES(d) 8
+#else
+#define _SSD1306_WIDTH(d) 128
+#define _SSD1306_PAGES(d) 4
 #endif
 
+// the back-buffer for the default OLED display
+// bits in here map to pixels on the display
+// no direct writes to display memory should occur
+// setting bits via functions will dirty flags for redraw
+#ifndef _SSD1306_NO_DEFAULT_DISPLAY
 #ifdef _SSD1306_DisplaySize128x32
-static unsigned char _DispBuff [4 * 128] = { 0 };
+SSD1306_DISPLAY (SSD1306_Default, _SSD1306_ADDRESS, 128, 32);
+#else
+SSD1306_DISPLAY (SSD1306_Default, _SSD1306_ADDRESS, 128, 64);
+#endif
 
-// dirty flags for render management (vertical banks)
-static unsigned char _DispDirty [4] = { 0 };
+// all drawing and rendering goes to the selected display
+static SSD1306_Display * _pDisp = &SSD1306_Default;
+#else
+static SSD1306_Display * _pDisp = NULL;
 #endif
 
 // char map needs to cover characters ASCII 32 to 126, so 95 character mappings
@@ -143,341 +194,518 @@ const unsigned char _CharMap [96 * 5] PROGMEM =
   0x08, 0x04, 0x08, 0x10, 0x08	// 126 ~ +
 };
 
-#ifdef _SSD1306_DisplaySize128x64
-// are any flags for dirty set?
-int SSD1306_IsDirty (void)
+// the character map above as a font descriptor for the pixel text functions
+const SSD1306_Font SSD1306_Font5x7 PROGMEM =
 {
-  for (int i = 0; i < 8; ++i)
-    if (_DispDirty[i])
-      return 1;
-  return 0;
+  31, 126,    // first / last character
+  8, 5, 1,    // height, fixed width, spacing
+  NULL,       // fixed width, no width table
+  NULL,       // fixed width, no offset table
+  _CharMap,
+  NULL        // no kerning
+};
+
+// direct drawing and rendering to another display instance
+void SSD1306_Select (SSD1306_Display * pDisp)
+{
+  _pDisp = pDisp;
+}
+
+SSD1306_Display * SSD1306_Selected (void)
+{
+  return _pDisp;
+}
+
+void SSD1306_SetBus (struct I2C_Bus * pBus)
+{
+  _pDisp->I2C = pBus;
 }
+
+int SSD1306_Health (void)
+{
+#ifdef _SSD1306_SPI
+  if (_pDisp->Bus == SSD1306_Bus_SPI)
+    return I2C_Ok;
 #endif
+  return I2C_State(_pDisp->Health);
+}
 
-#ifdef _SSD1306_DisplaySize128x32
 // are any flags for dirty set?
 int SSD1306_IsDirty (void)
 {
-  for (int i = 0; i < 4; ++i)
-    if (_DispDirty[i])
+  for (unsigned char i = 0; i < _SSD1306_PAGES(_pDisp); ++i)
+    if (_pDisp->Dirty[i].End)
       return 1;
   return 0;
 }
-#endif
 
-void SSD1306_Command8 (unsigned char command)
+// widen the dirty span of a bank to include columns [lo, end)
+static void SSD1306_MarkDirty (unsigned char page, unsigned char lo, unsigned char end)
 {
-  // send device address, intent to write
-  if (I2C_Start(_SSD1306_ADDRESS, I2C_WRITE))
-    return;
-  
-  // write command, more data, so no stop
-  if (I2C_Write8(0x00, I2C_NOSTOP))
-    return;
-  
-  // write the command
-  if (I2C_Write8(command, I2C_STOP))
+  SSD1306_Span * pSpan = _pDisp->Dirty + page;
+
+  if (!pSpan->End)
+  {
+    pSpan->Lo = lo;
+    pSpan->End = end;
     return;
+  }
+
+  if (lo < pSpan->Lo)
+    pSpan->Lo = lo;
+  if (end > pSpan->End)
+    pSpan->End = end;
 }
 
-void SSD1306_Command16 (unsigned char commandA, unsigned char commandB)
+static void SSD1306_MarkAllDirty (void)
 {
-  // send device address, intent to write
-  if (I2C_Start(_SSD1306_ADDRESS, I2C_WRITE))
-    return;
-  
-  // write command, more data, so no stop
-  if (I2C_Write8(0x00, I2C_NOSTOP))
-    return;
-  
-  // write the command
-  if (I2C_Write8(commandA, I2C_NOSTOP))
-    return;
+  for (unsigned char i = 0; i < _SSD1306_PAGES(_pDisp); ++i)
+  {
+    _pDisp->Dirty[i].Lo = 0;
+    _pDisp->Dirty[i].End = _SSD1306_WIDTH(_pDisp);
+  }
+}
 
-  // write the command
-  if (I2C_Write8(commandB, I2C_STOP))
-    return;
+// transport layer
+// every transfer is SSD1306_Begin with the I2C control byte (0x00 for a
+//  command stream, 0x40 for data) then SSD1306_Write per byte, with
+//  bLast set on the final byte to close the transaction
+// on I2C that is START, address, control byte ... STOP, run by
+//  SSD1306_Run as a transaction (I2C_Transact), which closes the bus if a
+//  step fails and keeps the display's health
+// on SPI that is CS low, D/C from the control byte ... CS high
+
+#ifdef _SSD1306_SPI
+// interrupt driven data stream state (one stream at a time, any display)
+static SSD1306_Display * volatile _pStream = NULL;
+static unsigned char * _pStreamRow;
+static unsigned char _ucStreamCol, _ucStreamLo, _ucStreamEnd, _ucStreamRows;
+
+// wait for a background stream to finish before touching the SPI bus
+static void SSD1306_SPIWait (void)
+{
+  while (_pStream)
+    ;
 }
 
-void SSD1306_Data (unsigned char * data, unsigned int iCount)
+// bring up the SPI module as master, mode 0, MSB first
+// SS (PB2) must stay an output (or held high) or the module drops out of
+//  master mode; MOSI is PB3 and SCK is PB5
+void SSD1306_SPIInit (SSD1306_SPIRate rate)
 {
-  // send device address, intent to write
-  if (I2C_Start(_SSD1306_ADDRESS, I2C_WRITE))
-    return;
+  // start code will power off all modules...
+  // ensure power is on : SPI
+  PRR &= ~(1 << PRSPI);
 
-  // write data, more data, so no stop
-  if (I2C_Write8(0x40, I2C_NOSTOP))
-    return;
-  
-  // do sequential writes, no stop until last byte
-  for (unsigned int i = 0; i < iCount - 1; ++i)
-  {
-    if (I2C_Write8(data[i], I2C_NOSTOP))
-      return;
-  }
-  
-  // last byte so issue stop
-  if (I2C_Write8(data[iCount - 1], I2C_STOP))
-    return;
+  DDRB |= (1 << PORTB2) | (1 << PORTB3) | (1 << PORTB5);
+
+  SPCR = (1 << SPE) | (1 << MSTR) | (rate & 0x03);
+  if (rate & 0x04)
+    SPSR |= (1 << SPI2X);
+  else
+    SPSR &= ~(1 << SPI2X);
 }
+#endif
 
-#ifdef _SSD1306_DisplaySize128x64
-void SSD1306_DispInit (SSD1306_Orientation screen_dir)
+static int SSD1306_Begin (unsigned char ucCtl)
 {
-  SSD1306_Command16 (0xA8, 0b10111111);   // set multiplex ratio P31 (default) (dim)
-  //SSD1306_Command16 (0xA8, 0b10001111);   // set multiplex ratio P31 (16)
-  
-  SSD1306_Command16 (0xD3, 0x00); // set display offset P31
-  SSD1306_Command8 (0x40);        // set display start line
-  
-  if (screen_dir)
+#ifdef _SSD1306_SPI
+  if (_pDisp->Bus == SSD1306_Bus_SPI)
   {
-    SSD1306_Command8 (0xA1);        // set segment remap
-    SSD1306_Command8 (0xC8);        // set com output map direction
+    SSD1306_SPIWait();
+
+    // D/C low for commands, high for data
+    if (ucCtl)
+      *_pDisp->DCPort |= _pDisp->DCMask;
+    else
+      *_pDisp->DCPort &= ~_pDisp->DCMask;
+
+    // select the display
+    *_pDisp->CSPort &= ~_pDisp->CSMask;
+    return 0;
   }
-  else
+#endif
+
+  // send device address, intent to write
+  if (I2C_BusStart(_pDisp->I2C, _pDisp->Addr, I2C_WRITE))
+    return -1;
+
+  // write control byte, more data, so no stop
+  if (I2C_BusWrite8(_pDisp->I2C, ucCtl, I2C_NOSTOP))
+    return -2;
+
+  return 0;
+}
+
+static int SSD1306_Write (unsigned char ucData, int bLast)
+{
+#ifdef _SSD1306_SPI
+  if (_pDisp->Bus == SSD1306_Bus_SPI)
   {
-    SSD1306_Command8 (0xA0);        // set segment remap
-    SSD1306_Command8 (0xC0);        // set com output map direction
+    SPDR = ucData;
+    while (!(SPSR & (1 << SPIF)))
+      ;
+
+    // deselect after the last byte
+    if (bLast)
+      *_pDisp->CSPort |= _pDisp->CSMask;
+    return 0;
   }
-  
-  SSD1306_Command16 (0xDA, 0b00010010); // set com pins hardware config (alternative) (default?)
+#endif
 
-  SSD1306_Command16 (0x81, 0x7F); // set contrast (1/2 level)
-  SSD1306_Command8 (0xA4);        // display on, use RAM
-  SSD1306_Command8 (0xA6);        // set normal display (1 == pixel on)
-  
-  SSD1306_Command16 (0xD5, 0x80); // set display clock to defaults
-  SSD1306_Command16 (0x8D, 0x14); // this is critical, final pages (separate charge pump section)
-  
-  //SSD1306_Command16 (0xD9, 0b00100010); // pre-charge period (default)
-  //SSD1306_Command16 (0xD9, 0b01000100); // pre-charge period (double?) not sure if this changed much
-  
-  SSD1306_Command8 (0xAF);        // display on, normal mode
-  
-  SSD1306_Command16 (0x20, 0x02); // page mode
-  
-  SSD1306_Clear();                // ram will be scrambled eggs, so clear display
+  if (I2C_BusWrite8(_pDisp->I2C, ucData, bLast ? I2C_STOP : I2C_NOSTOP))
+    return -3;
+
+  return 0;
 }
+
+// one transfer: the control byte, then the RAM bytes, then the flash bytes
+typedef struct SSD1306_Stream
+{
+  unsigned char Ctl;
+  const unsigned char * pRam;
+  unsigned int uiRam;
+  PGM_P pFlash;
+  unsigned char ucFlash;
+} SSD1306_Stream;
+
+// a rectangle of the back-buffer: banks PS..PE, columns [Lo, End)
+typedef struct SSD1306_Window
+{
+  unsigned char PS, PE, Lo, End;
+} SSD1306_Window;
+
+// run a transfer on the selected display, on I2C as a transaction
+static int SSD1306_Run (I2C_Xfer pXfer, void * pCtx)
+{
+#ifdef _SSD1306_SPI
+  // SPI can't fail
+  if (_pDisp->Bus == SSD1306_Bus_SPI)
+    return pXfer(NULL, 0, pCtx);
 #endif
 
-#ifdef _SSD1306_DisplaySize128x32
-void SSD1306_DispInit (SSD1306_Orientation screen_dir)
+  return I2C_Transact(_pDisp->I2C, _pDisp->Addr, &_pDisp->Health, pXfer, pCtx) ? -1 : 0;
+}
+
+static int SSD1306_StreamXfer (struct I2C_Bus * pBus, unsigned char uc7Addr, void * pCtx)
 {
-  SSD1306_Command16 (0xA8, 0x1F);   // set multiplex ratio P31 (default) (dim)
-  
-  SSD1306_Command16 (0xD3, 0x00); // set display offset P31
-  SSD1306_Command8 (0x40);        // set display start line
+  SSD1306_Stream * pS = pCtx;
+  const unsigned char * pRam = pS->pRam;
+  PGM_P pFlash = pS->pFlash;
+  unsigned int uiLeft = pS->uiRam + pS->ucFlash;
+  int iRet = SSD1306_Begin(pS->Ctl);
+
+  if (iRet)
+    return iRet;
 
-  if (screen_dir)
+  // transaction closes with the last byte, wherever it comes from
+  for (unsigned int i = pS->uiRam; i; --i)
   {
-    SSD1306_Command8 (0xA1);        // set segment remap
-    SSD1306_Command8 (0xC8);        // set com output map direction
+    if (SSD1306_Write(*pRam++, !--uiLeft))
+      return -3;
   }
-  else
+
+  for (unsigned char i = pS->ucFlash; i; --i)
   {
-    SSD1306_Command8 (0xA0);        // set segment remap
-    SSD1306_Command8 (0xC0);        // set com output map direction
+    if (SSD1306_Write(pgm_read_byte(pFlash++), !--uiLeft))
+      return -3;
   }
-  
-  SSD1306_Command16 (0xDA, 0x02); // set com pins hardware config (alternative) (default?)
-
-  SSD1306_Command16 (0x81, 0x7F); // set contrast (1/2 level)
-  SSD1306_Command8 (0xA4);        // display on, use RAM
-  SSD1306_Command8 (0xA6);        // set normal display (1 == pixel on)
-  
-  SSD1306_Command16 (0xD5, 0x80); // set display clock to defaults
-  SSD1306_Command16 (0x8D, 0x14); // this is critical, final pages (separate charge pump section)
-  
-  SSD1306_Command8 (0xAF);        // display on, normal mode
-  
-  SSD1306_Command16 (0x20, 0x02); // page mode
-  
-  SSD1306_Clear();                // ram will be scrambled eggs, so clear display
+  return 0;
 }
-#endif
 
-// no charge pump change (yet)
-void SSD1306_DisplayOn (void)
+// one transaction: control byte 0x00 (commands) or 0x40 (data), then the
+//  RAM bytes, then the flash bytes
+static int SSD1306_Send (unsigned char ucCtl, const unsigned char * pRam, unsigned int uiRam, PGM_P pFlash, unsigned char ucFlash)
 {
-  SSD1306_Command8 (0xAF);        // display on, normal mode
+  SSD1306_Stream stream = { ucCtl, pRam, uiRam, pFlash, ucFlash };
+
+  if (!uiRam && !ucFlash)
+    return 0;
+  return SSD1306_Run(SSD1306_StreamXfer, &stream);
 }
 
-// no charge pump change (yet)
-void SSD1306_DisplayOff (void)
+int SSD1306_Command8 (unsigned char command)
 {
-  SSD1306_Command8 (0xAE);        // display sleep
+  return SSD1306_Send(0x00, &command, 1, NULL, 0);
 }
 
-#ifdef _SSD1306_DisplaySize128x64
-// fill in ram with random junk
-void SSD1306_Noise (void)
+int SSD1306_Command16 (unsigned char commandA, unsigned char commandB)
 {
-  for (int i = 0; i < 1024; ++i)
-    _DispBuff[i] = rand() % 256;
-  
-  for (int i = 0; i < 8; ++i)
-    _DispDirty [i] = 1;
-  
-  SSD1306_Render();
+  unsigned char cmds [2] = { commandA, commandB };
+
+  return SSD1306_Send(0x00, cmds, 2, NULL, 0);
 }
-#endif
 
-#ifdef _SSD1306_DisplaySize128x32
-// fill in ram with random junk
-void SSD1306_Noise (void)
+int SSD1306_Data (unsigned char * data, unsigned int iCount)
 {
-  for (int i = 0; i < 512; ++i)
-    _DispBuff[i] = rand() % 256;
-  
-  for (int i = 0; i < 4; ++i)
-    _DispDirty [i] = 1;
-  
-  SSD1306_Render();
+  return SSD1306_Send(0x40, data, iCount, NULL, 0);
 }
-#endif
 
-#ifdef _SSD1306_DisplaySize128x64
-void SSD1306_Clear (void)
+// send a flash table of commands (with their parameters) in one transaction
+int SSD1306_CommandList (PGM_P pCmds, unsigned char ucCount)
 {
-  for (int i = 0; i < 1024; ++i)
-    _DispBuff[i] = 0;
-
-  for (int i = 0; i < 8; ++i)
-    _DispDirty [i] = 1;
-
-  SSD1306_Render ();
+  return SSD1306_Send(0x00, NULL, 0, pCmds, ucCount);
 }
-#endif
 
-#ifdef _SSD1306_DisplaySize128x32
-void SSD1306_Clear (void)
+// stream a rectangle of the back-buffer as one data transaction, the
+//  display wraps the column pointer inside the window set by the render
+//  commands
+static int SSD1306_WindowXfer (struct I2C_Bus * pBus, unsigned char uc7Addr, void * pCtx)
 {
-  for (int i = 0; i < 512; ++i)
-    _DispBuff[i] = 0;
+  SSD1306_Window * pW = pCtx;
+  int iRet = SSD1306_Begin(0x40);
 
-  for (int i = 0; i < 4; ++i)
-    _DispDirty [i] = 1;
+  // start a data stream
+  if (iRet)
+    return iRet;
 
-  SSD1306_Render ();
-}
+#if defined(_SSD1306_SPI) && !defined(_SSD1306_SPI_POLLED)
+  // on SPI the window is streamed by the transfer complete interrupt
+  //  and render returns right away
+  if (_pDisp->Bus == SSD1306_Bus_SPI)
+  {
+    _pStreamRow = _pDisp->Buff + pW->PS * _SSD1306_WIDTH(_pDisp);
+    _ucStreamLo = pW->Lo;
+    _ucStreamEnd = pW->End;
+    _ucStreamCol = pW->Lo + 1;
+    _ucStreamRows = pW->PE - pW->PS;
+    _pStream = _pDisp;
+
+    // first byte goes out here, the rest from the ISR
+    SPDR = _pStreamRow[pW->Lo];
+    SPCR |= (1 << SPIE);
+    return 0;
+  }
 #endif
 
-#ifdef _SSD1306_DisplaySize128x64
-void SSD1306_Render (void)
-{
-  // ensure we are at column 0 before bank output starts
-  SSD1306_Command8 (0x00);    // col 0
-  SSD1306_Command8 (0x10);    // col 0
+#ifdef _SSD1306_I2C_ASYNC
+  // on the TWI the window is streamed by the TWI interrupt, which ends it
+  //  with a STOP if a byte isn't ACKed (counted by the bus, not the health)
+  if (_pDisp->I2C == I2C_HW
+#ifdef _SSD1306_SPI
+    && _pDisp->Bus == SSD1306_Bus_I2C
+#endif
+    )
+  {
+    _pTwiRow = _pDisp->Buff + pW->PS * _SSD1306_WIDTH(_pDisp);
+    _ucTwiLo = pW->Lo;
+    _ucTwiEnd = pW->End;
+    _ucTwiCol = pW->Lo;
+    _ucTwiWidth = _SSD1306_WIDTH(_pDisp);
+    return I2C_WriteAsync(SSD1306_TwiNext, (unsigned int)(pW->PE - pW->PS + 1) * (pW->End - pW->Lo));
+  }
+#endif
 
-  // render each page, as necessary
-  for (int i = 0; i < 8; ++i)
+  for (unsigned char page = pW->PS; page <= pW->PE; ++page)
   {
-    // only update this area if dirty
-    if (_DispDirty[i])
+    unsigned char * pRow = _pDisp->Buff + page * _SSD1306_WIDTH(_pDisp);
+
+    for (unsigned char col = pW->Lo; col < pW->End; ++col)
     {
-      // mark as clean and render
-      _DispDirty[i] = 0;
-      SSD1306_Command8 (0xB0 + i);  // set bank
-      SSD1306_Data(_DispBuff + i * 128, 128); // dump bank
+      // last byte of the window closes the transaction
+      if (SSD1306_Write(pRow[col], page == pW->PE && col == pW->End - 1))
+        return -3;
     }
   }
+  return 0;
 }
-#endif
 
-#ifdef _SSD1306_DisplaySize128x32
-void SSD1306_Render (void)
+#if defined(_SSD1306_SPI) && !defined(_SSD1306_SPI_POLLED)
+// SPI transfer complete, feed the next byte of the render window
+ISR(SPI_STC_vect)
 {
-  // ensure we are at column 0 before bank output starts
-  SSD1306_Command8 (0x00);    // col 0
-  SSD1306_Command8 (0x10);    // col 0
-
-  // render each page, as necessary
-  for (int i = 0; i < 4; ++i)
+  if (_ucStreamCol >= _ucStreamEnd)
   {
-    // only update this area if dirty
-    if (_DispDirty[i])
+    if (!_ucStreamRows)
     {
-      // mark as clean and render
-      _DispDirty[i] = 0;
-      SSD1306_Command8 (0xB0 + i);  // set bank
-      SSD1306_Data(_DispBuff + i * 128, 128); // dump bank
+      // window done, deselect and release the bus
+      SPCR &= ~(1 << SPIE);
+      *_pStream->CSPort |= _pStream->CSMask;
+      _pStream = NULL;
+      return;
     }
+
+    // next bank of the window
+    --_ucStreamRows;
+    _pStreamRow += _SSD1306_WIDTH(_pStream);
+    _ucStreamCol = _ucStreamLo;
   }
+
+  SPDR = _pStreamRow[_ucStreamCol++];
 }
 #endif
 
-#ifdef _SSD1306_DisplaySize128x64
-void SSD1306_SetPage (int page, PGM_P buff)
+// is a background render still streaming?
+int SSD1306_Busy (void)
 {
-    if (page < 0 || page > 7)
-      return;
-    
-    _DispDirty[page] = 1;
-    
-    // copy out of flash to local display buffer
-    memcpy_P (_DispBuff + page * 128, buff, 128);
-    
-    //for (int iScan = 0; iScan < 128; ++iScan)
-    //  _DispBuff[page * 128 + iScan] = buff[iScan];
+  int bBusy = 0;
+
+#ifdef _SSD1306_SPI
+  bBusy = _pStream != NULL;
+#endif
+#ifdef _SSD1306_I2C_ASYNC
+  bBusy = bBusy || I2C_Busy();
+#endif
+  return bBusy;
 }
+
+// geometry independent part of bring-up, sent after the geometry and
+//  orientation commands in the same transaction
+static const unsigned char _InitCommands [] PROGMEM =
+{
+  0xD3, 0x00,         // set display offset P31
+  0x40,               // set display start line
+  0x81, 0x7F,         // set contrast (1/2 level)
+  0xA4,               // display on, use RAM
+  0xA6,               // set normal display (1 == pixel on)
+  0xD5, 0x80,         // set display clock to defaults
+  0x8D, 0x14,         // this is critical, final pages (separate charge pump section)
+  //0xD9, 0b00100010, // pre-charge period (default)
+  //0xD9, 0b01000100, // pre-charge period (double?) not sure if this changed much
+  0x20, 0x00,         // horizontal addressing mode (render windows wrap)
+  0xAF                // display on, normal mode
+};
+
+int SSD1306_DispInit (SSD1306_Orientation screen_dir)
+{
+  int iRet;
+  unsigned char cmds [6] =
+  {
+    0xA8, _SSD1306_PAGES(_pDisp) * 8 - 1, // set multiplex ratio P31 (height - 1)
+    // set com pins hardware config
+    // 128 x 64 panels use alternative com pins, 128 x 32 sequential
+    0xDA, (_SSD1306_PAGES(_pDisp) > 4) ? 0b00010010 : 0x02,
+    screen_dir ? 0xA1 : 0xA0,             // set segment remap
+    screen_dir ? 0xC8 : 0xC0              // set com output map direction
+  };
+
+#ifdef _SSD1306_SPI
+  if (_pDisp->Bus == SSD1306_Bus_SPI)
+  {
+    // D/C and CS are outputs (DDRx sits just below PORTx), CS idles high
+    *_pDisp->CSPort |= _pDisp->CSMask;
+    *(_pDisp->DCPort - 1) |= _pDisp->DCMask;
+    *(_pDisp->CSPort - 1) |= _pDisp->CSMask;
+  }
 #endif
 
-#ifdef _SSD1306_DisplaySize128x32
-void SSD1306_SetPage (int page, PGM_P buff)
+  // whole bring-up is a single transaction
+  iRet = SSD1306_Send (0x00, cmds, sizeof(cmds), (PGM_P)_InitCommands, sizeof(_InitCommands));
+  
+  // ram will be scrambled eggs, so clear display (the back-buffer anyway)
+  if (SSD1306_Clear() || iRet)
+    return -1;
+  return 0;
+}
+
+// no charge pump change (yet)
+int SSD1306_DisplayOn (void)
 {
-    if (page < 0 || page > 4)
-      return;
-    
-    _DispDirty[page] = 1;
-    
-    // copy out of flash to local display buffer
-    memcpy_P (_DispBuff + page * 128, buff, 128);
-    
-    //for (int iScan = 0; iScan < 128; ++iScan)
-    //  _DispBuff[page * 128 + iScan] = buff[iScan];
+  return SSD1306_Command8 (0xAF); // display on, normal mode
 }
-#endif
 
-#ifdef _SSD1306_DisplaySize128x64
-void SSD1306_SetPixel (int iX, int iY)
+// no charge pump change (yet)
+int SSD1306_DisplayOff (void)
 {
-  // stay in range or do nothing
-  if (iX < 0 || iX > 127)
-    return;
-  
-  if (iY < 0 || iY > 63)
-    return;
+  return SSD1306_Command8 (0xAE); // display sleep
+}
+
+// fill in ram with random junk
+int SSD1306_Noise (void)
+{
+  unsigned int uiSize = _SSD1306_PAGES(_pDisp) * _SSD1306_WIDTH(_pDisp);
+
+  for (unsigned int i = 0; i < uiSize; ++i)
+    _pDisp->Buff[i] = rand() % 256;
   
-  // figure out in memory where this is and set bit
-  int iByte = iX + (iY / 8) * 128;
-  _DispBuff[iByte] |= 1 << (iY % 8);
+  SSD1306_MarkAllDirty();
   
-  // mark affected bank as dirty
-  _DispDirty[iY/8] = 1;
+  return SSD1306_Render();
+}
+
+int SSD1306_Clear (void)
+{
+  memset (_pDisp->Buff, 0, _SSD1306_PAGES(_pDisp) * _SSD1306_WIDTH(_pDisp));
+
+  SSD1306_MarkAllDirty();
+
+  return SSD1306_Render ();
+}
+
+// pushes the bounding window of all dirty spans: one command transaction
+//  to set the column/page window, then one data transaction
+// clean banks or columns inside the window are resent, which is cheaper
+//  than the per-bank addressing overhead for typical updates
+// if either transaction fails the window is left dirty for the next render
+int SSD1306_Render (void)
+{
+  unsigned char ucPS = 0xFF, ucPE = 0, ucLo = 0xFF, ucEnd = 0;
+
+  // find the window, marking everything clean as we go
+  for (unsigned char i = 0; i < _SSD1306_PAGES(_pDisp); ++i)
+  {
+    SSD1306_Span * pSpan = _pDisp->Dirty + i;
+    if (!pSpan->End)
+      continue;
+
+    if (ucPS == 0xFF)
+      ucPS = i;
+    ucPE = i;
+    if (pSpan->Lo < ucLo)
+      ucLo = pSpan->Lo;
+    if (pSpan->End > ucEnd)
+      ucEnd = pSpan->End;
+    pSpan->End = 0;
+  }
+
+  // nothing to do
+  if (ucPS == 0xFF)
+    return 0;
+
+  unsigned char cmds [6] =
+  {
+    0x21, ucLo, ucEnd - 1,  // column window
+    0x22, ucPS, ucPE        // page window
+  };
+  SSD1306_Window window = { ucPS, ucPE, ucLo, ucEnd };
+
+  if (!SSD1306_Send (0x00, cmds, sizeof(cmds), NULL, 0) && !SSD1306_Run (SSD1306_WindowXfer, &window))
+    return 0;
+
+  for (unsigned char i = ucPS; i <= ucPE; ++i)
+    SSD1306_MarkDirty (i, ucLo, ucEnd);
+  return -1;
+}
+
+void SSD1306_SetPage (int page, PGM_P buff)
+{
+    if (page < 0 || page >= _SSD1306_PAGES(_pDisp))
+      return;
+    
+    SSD1306_MarkDirty (page, 0, _SSD1306_WIDTH(_pDisp));
+    
+    // copy out of flash to local display buffer
+    memcpy_P (_pDisp->Buff + page * _SSD1306_WIDTH(_pDisp), buff, _SSD1306_WIDTH(_pDisp));
 }
-#endif
 
-#ifdef _SSD1306_DisplaySize128x32
 void SSD1306_SetPixel (int iX, int iY)
 {
   // stay in range or do nothing
-  if (iX < 0 || iX > 127)
+  if (iX < 0 || iX >= _SSD1306_WIDTH(_pDisp))
     return;
   
-  if (iY < 0 || iY > 31)
+  if (iY < 0 || iY >= _SSD1306_PAGES(_pDisp) * 8)
     return;
   
   // figure out in memory where this is and set bit
-  int iByte = iX + (iY / 8) * 128;
-  _DispBuff[iByte] |= 1 << (iY % 8);
+  int iByte = iX + (iY / 8) * _SSD1306_WIDTH(_pDisp);
+  _pDisp->Buff[iByte] |= 1 << (iY % 8);
   
   // mark affected bank as dirty
-  _DispDirty[iY/8] = 1;
+  SSD1306_MarkDirty (iY / 8, iX, iX + 1);
 }
-#endif
 
-void SSD1306_SetInverse (int IsInverse)
+int SSD1306_SetInverse (int IsInverse)
 {
 	if (IsInverse)
 		return SSD1306_Command8(0xA7);
@@ -515,8 +743,11 @@ void SSD1306_Circle (int iXS, int iYS, float fRad)
 
 void SSD1306_Line (int iXS, int iYS, int iXE, int iYE)
 {
+  int iW = _SSD1306_WIDTH(_pDisp);
+  int iH = _SSD1306_PAGES(_pDisp) * 8;
+
   // validate that start and end are in range and in order
-  if (iXS < 0 || iXS > 127 || iYS < 0 || iYS > 63 || iXE < 0 || iXE > 127 || iYE < 0 || iYE > 63)
+  if (iXS < 0 || iXS >= iW || iYS < 0 || iYS >= iH || iXE < 0 || iXE >= iW || iYE < 0 || iYE >= iH)
     return;
   
   // now step through the larger of the two axes displacements and move in 1/2 steps
@@ -549,63 +780,31 @@ void SSD1306_Line (int iXS, int iYS, int iXE, int iYE)
   }
 }
 
-#ifdef _SSD1306_DisplaySize128x64
 // target locations are aligned to stops of 6 on the x, and 8 on the y, with 5 x 7 characters
 void SSD1306_CharXY (unsigned char iX, unsigned char iY, char disp)
 {
   // ensure axes in range, could be called with automation, so no error, just fix
-  iX = iX % 22;
-  iY = iY % 8;
+  iX = iX % (_SSD1306_WIDTH(_pDisp) / 6);
+  iY = iY % _SSD1306_PAGES(_pDisp);
   
   // keep display character in range or show as space
   if (disp < 31 || disp > 126)
     disp = ' ';
   
   // figure out where in the buffer this is
-  int iStartIndex = iX * 6 + iY * 128;
-  
-  // copy the appropriate pixel map bits into this location
-  //for (int i = 0; i < 5; ++i)
-    //_DispBuff[iStartIndex++] = _CharMap [(disp - 31) * 5 + i]; // need to adjust to use full map
-    // writing it this way does not appear to be necessary as the array type above is known
-  //  _DispBuff[iStartIndex++] = *(const __flash unsigned char *)(_CharMap + ((disp - 31) * 5 + i)); // need to adjust to use full map
+  int iStartIndex = iX * 6 + iY * _SSD1306_WIDTH(_pDisp);
   
-  // updated when switched to basic AVR code, uses program memory copy function to copy from flash
-  memcpy_P (_DispBuff + iStartIndex, _CharMap + (disp - 31) * 5, 5);
-  
-  // mark affected page as dirty
-  _DispDirty[iY] = 1;
-}
-#endif
+  // a cell already showing the character stays clean (the back-buffer is
+  //  the text shadow, rewriting the same text sends nothing)
+  if (!memcmp_P (_pDisp->Buff + iStartIndex, _CharMap + (disp - 31) * 5, 5))
+    return;
 
-#ifdef _SSD1306_DisplaySize128x32
-// target locations are aligned to stops of 6 on the x, and 8 on the y, with 5 x 7 characters
-void SSD1306_CharXY (unsigned char iX, unsigned char iY, char disp)
-{
-  // ensure axes in range, could be called with automation, so no error, just fix
-  iX = iX % 22;
-  iY = iY % 4;
-  
-  // keep display character in range or show as space
-  if (disp < 31 || disp > 126)
-    disp = ' ';
-  
-  // figure out where in the buffer this is
-  int iStartIndex = iX * 6 + iY * 128;
-  
-  // copy the appropriate pixel map bits into this location
-  //for (int i = 0; i < 5; ++i)
-    //_DispBuff[iStartIndex++] = _CharMap [(disp - 31) * 5 + i]; // need to adjust to use full map
-    // writing it this way does not appear to be necessary as the array type above is known
-  //  _DispBuff[iStartIndex++] = *(const __flash unsigned char *)(_CharMap + ((disp - 31) * 5 + i)); // need to adjust to use full map
-  
   // updated when switched to basic AVR code, uses program memory copy function to copy from flash
-  memcpy_P (_DispBuff + iStartIndex, _CharMap + (disp - 31) * 5, 5);
+  memcpy_P (_pDisp->Buff + iStartIndex, _CharMap + (disp - 31) * 5, 5);
   
   // mark affected page as dirty
-  _DispDirty[iY] = 1;
+  SSD1306_MarkDirty (iY, iX * 6, iX * 6 + 5);
 }
-#endif
 
 void SSD1306_StringXY (unsigned char iX, unsigned char iY, char * pStr)
 {
@@ -618,11 +817,171 @@ void SSD1306_StringXY (unsigned char iX, unsigned char iY, char * pStr)
     pStr = pStr + 1;
     
     // do row and column wrapping
-    if (++iX > 20)
+    if (++iX >= _SSD1306_WIDTH(_pDisp) / 6)
     {
       iX=0;
-      if (++iY > 7)
+      if (++iY >= _SSD1306_PAGES(_pDisp))
         iY=0;
     }
   }
-}
\ No newline at end of file
+}
+
+// copy a PROGMEM bitmap to any pixel position, clipped to the display
+// bitmap layout matches display memory: ceil(ucH / 8) rows of ucW column
+//  bytes, LSB at the top of each row (NULL bitmap is a solid block)
+// each source byte is shifted across the (up to) two pages it lands in
+//  and merged with a single mask op, so there are no per-pixel calls
+static void SSD1306_BlitCore (int iX, int iY, unsigned char ucW, unsigned char ucH, PGM_P bmp, SSD1306_BlitMode mode)
+{
+  // clip columns, nothing to do if entirely off screen
+  int iXS = (iX < 0) ? 0 : iX;
+  int iXE = iX + ucW;
+  if (iXE > _SSD1306_WIDTH(_pDisp))
+    iXE = _SSD1306_WIDTH(_pDisp);
+  if (iXS >= iXE || iY >= _SSD1306_PAGES(_pDisp) * 8 || iY + ucH <= 0)
+    return;
+
+  unsigned char ucShift = iY & 0x07;
+  unsigned char ucSrcPages = (ucH + 7) / 8;
+
+  for (unsigned char sp = 0; sp < ucSrcPages; ++sp)
+  {
+    // destination bank of the top of this source row (may be off screen)
+    int iPage = (iY + sp * 8 - ucShift) / 8;
+    if (iPage >= _SSD1306_PAGES(_pDisp))
+      break;
+    if (iPage < -1)
+      continue;
+
+    // only the bits that belong to the bitmap take part (last row may be short)
+    unsigned char ucValid = (ucH - sp * 8 >= 8) ? 0xFF : (1 << (ucH - sp * 8)) - 1;
+    unsigned int uiMask = (unsigned int)ucValid << ucShift;
+
+    // the two banks this row straddles, NULL if clipped
+    unsigned char * pLo = (iPage >= 0) ? _pDisp->Buff + iPage * _SSD1306_WIDTH(_pDisp) : NULL;
+    unsigned char * pHi = (ucShift && iPage + 1 < _SSD1306_PAGES(_pDisp)) ? _pDisp->Buff + (iPage + 1) * _SSD1306_WIDTH(_pDisp) : NULL;
+    if (!pLo && !pHi)
+      continue;
+
+    PGM_P pSrc = bmp ? bmp + sp * ucW + (iXS - iX) : NULL;
+    for (int col = iXS; col < iXE; ++col)
+    {
+      unsigned int uiBits = pSrc ? ((unsigned int)pgm_read_byte(pSrc++) << ucShift) & uiMask : uiMask;
+
+      // every mode is new = (old & ~clr) ^ set
+      unsigned int uiClr = (mode == SSD1306_BLIT_XOR) ? 0 : (mode == SSD1306_BLIT_OVERWRITE) ? uiMask : uiBits;
+      unsigned int uiSet = (mode == SSD1306_BLIT_CLEAR) ? 0 : uiBits;
+
+      if (pLo)
+        pLo[col] = (pLo[col] & ~(unsigned char)uiClr) ^ (unsigned char)uiSet;
+      if (pHi)
+        pHi[col] = (pHi[col] & ~(unsigned char)(uiClr >> 8)) ^ (unsigned char)(uiSet >> 8);
+    }
+
+    if (pLo)
+      SSD1306_MarkDirty (iPage, iXS, iXE);
+    if (pHi)
+      SSD1306_MarkDirty (iPage + 1, iXS, iXE);
+  }
+}
+
+void SSD1306_Blit (int iX, int iY, unsigned char ucW, unsigned char ucH, PGM_P bmp, SSD1306_BlitMode mode)
+{
+  if (!bmp)
+    return;
+  SSD1306_BlitCore (iX, iY, ucW, ucH, bmp, mode);
+}
+
+// solid rectangle (SET fills, CLEAR erases, XOR inverts)
+void SSD1306_FillRect (int iX, int iY, unsigned char ucW, unsigned char ucH, SSD1306_BlitMode mode)
+{
+  SSD1306_BlitCore (iX, iY, ucW, ucH, NULL, mode);
+}
+
+// find the flash bitmap and width of a glyph, NULL if not in the font
+static PGM_P SSD1306_FontGlyph (const SSD1306_Font * pF, char disp, unsigned char * pWidth)
+{
+  unsigned char uc = disp;
+  *pWidth = 0;
+
+  if (uc < pF->First || uc > pF->Last)
+    return NULL;
+  uc -= pF->First;
+
+  *pWidth = pF->Widths ? pgm_read_byte(pF->Widths + uc) : pF->Width;
+  if (!*pWidth)
+    return NULL;
+
+  if (pF->Offsets)
+    return (PGM_P)(pF->Bitmaps + pgm_read_word(pF->Offsets + uc));
+  return (PGM_P)(pF->Bitmaps + uc * pF->Width * ((pF->Height + 7) / 8));
+}
+
+// kerning adjustment between two characters (pair table is flash triples)
+static signed char SSD1306_FontKern (const SSD1306_Font * pF, char left, char right)
+{
+  if (!pF->Kerning)
+    return 0;
+
+  for (const signed char * pPair = pF->Kerning; pgm_read_byte(pPair); pPair += 3)
+  {
+    if (pgm_read_byte(pPair) == (unsigned char)left && pgm_read_byte(pPair + 1) == (unsigned char)right)
+      return (signed char)pgm_read_byte(pPair + 2);
+  }
+  return 0;
+}
+
+// lay out (and optionally draw) a string, returns x past the last glyph
+static int SSD1306_FontRun (const SSD1306_Font * pFont, int iX, int iY, const char * pStr, SSD1306_BlitMode mode, int bDraw)
+{
+  SSD1306_Font f;
+  memcpy_P (&f, pFont, sizeof(f));
+
+  for (const char * pC = pStr; *pC; ++pC)
+  {
+    // inter-character gap (spacing plus kerning), erased in overwrite mode
+    if (pC != pStr)
+    {
+      int iGap = f.Spacing + SSD1306_FontKern(&f, pC[-1], *pC);
+      if (bDraw && iGap > 0 && mode == SSD1306_BLIT_OVERWRITE)
+        SSD1306_FillRect (iX, iY, iGap, f.Height, SSD1306_BLIT_CLEAR);
+      iX += iGap;
+    }
+
+    unsigned char ucW;
+    PGM_P pBits = SSD1306_FontGlyph(&f, *pC, &ucW);
+    if (!pBits)
+    {
+      // not in the font, show as a blank cell of the nominal width
+      if (bDraw && mode == SSD1306_BLIT_OVERWRITE)
+        SSD1306_FillRect (iX, iY, f.Width, f.Height, SSD1306_BLIT_CLEAR);
+      iX += f.Width;
+      continue;
+    }
+
+    if (bDraw)
+      SSD1306_BlitCore (iX, iY, ucW, f.Height, pBits, mode);
+    iX += ucW;
+  }
+
+  return iX;
+}
+
+// draw one glyph at any pixel position, returns the glyph width
+int SSD1306_FontCharXY (const SSD1306_Font * pFont, int iX, int iY, char disp, SSD1306_BlitMode mode)
+{
+  char str[2] = { disp, 0 };
+  return SSD1306_FontRun (pFont, iX, iY, str, mode, 1) - iX;
+}
+
+// draw a string at any pixel position, returns x past the last glyph
+int SSD1306_FontStringXY (const SSD1306_Font * pFont, int iX, int iY, const char * pStr, SSD1306_BlitMode mode)
+{
+  return SSD1306_FontRun (pFont, iX, iY, pStr, mode, 1);
+}
+
+// width in pixels the string would occupy (for alignment)
+int SSD1306_FontStringWidth (const SSD1306_Font * pFont, const char * pStr)
+{
+  return SSD1306_FontRun (pFont, 0, 0, pStr, SSD1306_BLIT_SET, 0);
+}
@@ -3,11 +3,19 @@
 // Device variant changes - Diarmid Rendell
 // working as of May 19/2022
 // April 14th - Added enum for display orientation (tested only on 128 x 32 devices)
+// Oct 2026 - Display instances (SSD1306_Display / SSD1306_Select) for multiple panels
+// Oct 2026 - SSD1306_CommandList for flash command sequences
+// Oct 2026 - 4-wire SPI transport (_SSD1306_SPI)
+// Oct 2026 - SSD1306_CharXY leaves a cell that already shows the character clean
+// Oct 2026 - I2C displays on any bus (SSD1306_SetBus), TWI render windows
+//             streamed by the TWI interrupt (_SSD1306_I2C_ASYNC)
+// Oct 2026 - I2C transfers as transactions (I2C_Transact), health per display
+//             (SSD1306_Health), management calls return 0 or -1
 
 // private helpers
-//void SSD1306_Command8 (unsigned char command);
-//void SSD1306_Command16 (unsigned char commandA, unsigned char commandB);
-//void SSD1306_Data (unsigned char * data, unsigned int iCount);
+//int SSD1306_Command8 (unsigned char command);
+//int SSD1306_Command16 (unsigned char commandA, unsigned char commandB);
+//int SSD1306_Data (unsigned char * data, unsigned int iCount);
 
 #include <avr/pgmspace.h> // defines to place items in flash (program memory)
 
@@ -16,14 +24,110 @@
 #endif
 
 // comment in/out the appropriate size of your display! ****
-#ifndef _SSD1306_DisplaySize128x32
-#define _SSD1306_DisplaySize128x32
-#endif
+// (or define one/both on the command line)
 //#ifndef _SSD1306_DisplaySize128x64
 //#define _SSD1306_DisplaySize128x64
 //#endif
+#if !defined(_SSD1306_DisplaySize128x32) && !defined(_SSD1306_DisplaySize128x64)
+#define _SSD1306_DisplaySize128x32
+#endif
 // comment in/out the appropriate size of your display! ****
 
+// with a single geometry built, all instances must be that size and the
+//  geometry math compiles to constants
+// with both built, geometry comes from each instance at run time
+//  (the default instance is then 128 x 32)
+#if defined(_SSD1306_DisplaySize128x32) && defined(_SSD1306_DisplaySize128x64)
+#define _SSD1306_MULTI_GEOMETRY
+#endif
+
+// define _SSD1306_NO_DEFAULT_DISPLAY to drop the built-in instance (and its
+//  back-buffer) when the application declares its own with SSD1306_DISPLAY
+
+// define _SSD1306_SPI to build the 4-wire hardware SPI transport
+//  (SSD1306_DISPLAY_SPI instances, SSD1306_SPIInit)
+// on SPI the render window is streamed by the transfer complete interrupt
+//  (global interrupts must be on), SSD1306_Busy reports a stream in flight,
+//  define _SSD1306_SPI_POLLED to stream inline instead (at fosc/2 the
+//  byte time is shorter than the ISR overhead, so polled is quicker but
+//  holds the CPU)
+
+// define _SSD1306_I2C_ASYNC to stream the render window of a display on
+//  the TWI from the TWI interrupt (I2C_WriteAsync, global interrupts must
+//  be on), so the CPU (or a software I2C bus) is free while it goes out,
+//  SSD1306_Busy reports it. The next transaction on the TWI waits for it
+
+struct I2C_Bus;
+
+#ifdef _SSD1306_SPI
+// bus the display is attached to
+typedef enum SSD1306_Bus
+{
+  SSD1306_Bus_I2C,
+  SSD1306_Bus_SPI
+} SSD1306_Bus;
+
+// SPI clock, bit 2 is SPI2X, bits 1:0 are SPR1:SPR0
+typedef enum SSD1306_SPIRate
+{
+  SSD1306_SPIRate_Div2 = 0x04,
+  SSD1306_SPIRate_Div4 = 0x00,
+  SSD1306_SPIRate_Div8 = 0x05,
+  SSD1306_SPIRate_Div16 = 0x01
+} SSD1306_SPIRate;
+#endif
+
+// dirty columns of one bank: [Lo, End), clean when End == 0
+typedef struct SSD1306_Span
+{
+  unsigned char Lo;
+  unsigned char End;
+} SSD1306_Span;
+
+// a display instance, all drawing goes to the selected instance
+typedef struct SSD1306_Display
+{
+  unsigned char Addr;       // 7-bit I2C address
+  unsigned char Width;      // pixels
+  unsigned char Height;     // pixels, multiple of 8
+  unsigned char * Buff;     // back-buffer, Height / 8 banks of Width bytes
+  SSD1306_Span * Dirty;     // dirty span per bank
+  struct I2C_Bus * I2C;     // I2C bus (0, I2C_HW, for the TWI)
+  unsigned char Health;     // I2C failures in a row (I2C_Transact)
+#ifdef _SSD1306_SPI
+  SSD1306_Bus Bus;                    // I2C (default) or SPI
+  volatile unsigned char * DCPort;    // SPI: PORTx of the D/C pin
+  unsigned char DCMask;
+  volatile unsigned char * CSPort;    // SPI: PORTx of the CS pin
+  unsigned char CSMask;
+#endif
+} SSD1306_Display;
+
+// declare an instance with its own back-buffer and dirty spans, ex:
+//  SSD1306_DISPLAY (_Left, 0x3C, 128, 32);
+//  SSD1306_DISPLAY (_Right, 0x3D, 128, 32);
+//  ...
+//  SSD1306_Select (&_Right);
+#define SSD1306_DISPLAY(name, addr, width, height) \
+  static unsigned char name##_Buff [(width) * ((height) / 8)]; \
+  static SSD1306_Span name##_Dirty [(height) / 8]; \
+  SSD1306_Display name = { (addr), (width), (height), name##_Buff, name##_Dirty, 0, 0 }
+
+#ifdef _SSD1306_SPI
+// as above for a display on the SPI bus, D/C and CS pins by port and bit, ex:
+//  SSD1306_DISPLAY_SPI (_Oled, 128, 64, PORTD, PORTD4, PORTD5);
+#define SSD1306_DISPLAY_SPI(name, width, height, dcport, dcbit, csport, csbit) \
+  static unsigned char name##_Buff [(width) * ((height) / 8)]; \
+  static SSD1306_Span name##_Dirty [(height) / 8]; \
+  SSD1306_Display name = { 0, (width), (height), name##_Buff, name##_Dirty, 0, 0, \
+    SSD1306_Bus_SPI, &(dcport), 1 << (dcbit), &(csport), 1 << (csbit) }
+#endif
+
+#ifndef _SSD1306_NO_DEFAULT_DISPLAY
+// built-in instance at _SSD1306_ADDRESS, selected at startup
+extern SSD1306_Display SSD1306_Default;
+#endif
+
 // screen orientation
 typedef enum SSD1306_Orientation
 {
@@ -31,20 +135,83 @@ typedef enum SSD1306_Orientation
   SSD1306_OR_Down
 } SSD1306_Orientation;
 
-// management
-void SSD1306_DispInit (SSD1306_Orientation screen_dir);
-void SSD1306_Noise (void);
-void SSD1306_Clear (void);
-void SSD1306_Render (void);
+// bitmap blit modes
+typedef enum SSD1306_BlitMode
+{
+  SSD1306_BLIT_SET,       // OR bitmap onto display
+  SSD1306_BLIT_CLEAR,     // clear display pixels where bitmap is set
+  SSD1306_BLIT_XOR,       // toggle display pixels where bitmap is set
+  SSD1306_BLIT_OVERWRITE  // replace display pixels under the bitmap
+} SSD1306_BlitMode;
+
+// font descriptor, lives in flash along with its tables
+// glyph bitmaps use the SSD1306_Blit layout: ceil(Height / 8) rows of
+//  column bytes, LSB on top
+// characters outside First..Last (or with a zero width) render as a
+//  blank cell of the nominal Width
+typedef struct SSD1306_Font
+{
+  unsigned char First;            // first character in the font
+  unsigned char Last;             // last character in the font
+  unsigned char Height;           // glyph height in pixels
+  unsigned char Width;            // fixed / nominal glyph width
+  unsigned char Spacing;          // blank columns between glyphs
+  const unsigned char * Widths;   // per glyph width, NULL if fixed width
+  const unsigned int * Offsets;   // per glyph byte offset, NULL if fixed width
+  const unsigned char * Bitmaps;  // glyph column bytes
+  const signed char * Kerning;    // (left, right, adjust) triples, 0 ends, or NULL
+} SSD1306_Font;
+
+// fonts (all in flash)
+extern const SSD1306_Font SSD1306_Font5x7 PROGMEM;      // fixed 5 x 7, same as SSD1306_CharXY
+extern const SSD1306_Font SSD1306_FontProp5x7 PROGMEM;  // proportional 5 x 7
+extern const SSD1306_Font SSD1306_FontNum16 PROGMEM;    // 16 px digits, '-', '.', ':'
+extern const SSD1306_Font SSD1306_FontNum24 PROGMEM;    // 24 px digits, '-', '.', ':'
+extern const SSD1306_Font SSD1306_FontNum32 PROGMEM;    // 32 px digits, '-', '.', ':'
+
+// instance selection
+void SSD1306_Select (SSD1306_Display * pDisp);
+SSD1306_Display * SSD1306_Selected (void);
+
+// put the selected display on an I2C bus (I2C.h), before SSD1306_DispInit
+void SSD1306_SetBus (struct I2C_Bus * pBus);
+
+#ifdef _SSD1306_SPI
+// bring up the SPI module (once, before SSD1306_DispInit on an SPI display)
+// takes PB2 (SS), PB3 (MOSI) and PB5 (SCK) as outputs, none of them can be
+//  an input in the app: SS must be an output (or held high) in master mode
+void SSD1306_SPIInit (SSD1306_SPIRate rate);
+#endif
+
+// management, -1 if the display didn't take it (a render that fails is
+//  left dirty, the next one sends it again)
+int SSD1306_DispInit (SSD1306_Orientation screen_dir);
+int SSD1306_Noise (void);
+int SSD1306_Clear (void);
+int SSD1306_Render (void);
 int SSD1306_IsDirty (void);
-void SSD1306_DisplayOn (void);
-void SSD1306_DisplayOff (void);
-void SSD1306_SetInverse (int IsInverse);
+int SSD1306_Busy (void);    // render still streaming in the background (SPI, TWI)
+int SSD1306_DisplayOn (void);
+int SSD1306_DisplayOff (void);
+int SSD1306_SetInverse (int IsInverse);
+
+// I2C_Ok, I2C_Degraded or I2C_Offline (I2C.h) for the selected display, an
+//  offline display costs nothing on the bus but a probe now and then
+int SSD1306_Health (void);
+
+// send a flash table of commands (with parameters) as one transaction
+int SSD1306_CommandList (PGM_P pCmds, unsigned char ucCount);
 
 // string
 void SSD1306_CharXY (unsigned char iX, unsigned char iY, char disp);
 void SSD1306_StringXY (unsigned char iX, unsigned char iY, char * pStr);
 
+// text at any pixel position, in any font
+// return the glyph width / x past the last glyph
+int SSD1306_FontCharXY (const SSD1306_Font * pFont, int iX, int iY, char disp, SSD1306_BlitMode mode);
+int SSD1306_FontStringXY (const SSD1306_Font * pFont, int iX, int iY, const char * pStr, SSD1306_BlitMode mode);
+int SSD1306_FontStringWidth (const SSD1306_Font * pFont, const char * pStr);
+
 // graphics
 void SSD1306_SetPixel (int iX, int iY);
 void SSD1306_Line (int iXS, int iYS, int iXE, int iYE);
@@ -52,3 +219,10 @@ void SSD1306_Circle (int iXS, int iYS, float fRad);
 
 // requires the page data to be in flash
 void SSD1306_SetPage (int page, PGM_P buff);
+
+// bitmap at any pixel position, clipped (bitmap must be in flash)
+// layout: ceil(ucH / 8) rows of ucW column bytes, LSB on top
+void SSD1306_Blit (int iX, int iY, unsigned char ucW, unsigned char ucH, PGM_P bmp, SSD1306_BlitMode mode);
+
+// solid rectangle (SET fills, CLEAR erases, XOR inverts)
+void SSD1306_FillRect (int iX, int iY, unsigned char ucW, unsigned char ucH, SSD1306_BlitMode mode);
@@ -0,0 +1,293 @@
+// fonts for SSD1306 OLED display
+// Oct 2026 - proportional 5 x 7 and large numeric faces for SSD1306_FontStringXY
+//
+// glyph data is in the SSD1306_Blit layout, see SSD1306.h
+// unused fonts are dropped by the linker (data sections + gc sections)
+
+#include "SSD1306.h"
+#include <stdlib.h>
+
+// the fixed 5 x 7 map lives with the driver
+extern const unsigned char _CharMap [96 * 5] PROGMEM;
+
+// proportional 5 x 7, shares the glyph columns of _CharMap
+// widths and offsets skip the blank columns of each fixed cell
+static const unsigned char _Prop5x7Widths [96] PROGMEM =
+{
+  5, 3, 1, 3, 5, 5, 5, 5, 1, 3, 3, 5, 3, 2, 3, 2,   // 31 - 46
+  5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 2, 2, 4, 3, 4,   // 47 - 62
+  5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,   // 63 - 78
+  5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 3, 5, 3, 5,   // 79 - 94
+  5, 2, 5, 5, 5, 5, 5, 5, 5, 5, 1, 4, 4, 1, 5, 5,   // 95 - 110
+  5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 4, 3, 1, 3, 5   // 111 - 126
+};
+
+static const unsigned int _Prop5x7Offsets [96] PROGMEM =
+{
+  0, 5, 12, 16, 20, 25, 30, 35, 42, 46, 51, 55,   // 31 - 42
+  61, 66, 71, 76, 80, 85, 90, 95, 100, 105, 110, 115,   // 43 - 54
+  120, 125, 130, 136, 141, 145, 151, 156, 160, 165, 170, 175,   // 55 - 66
+  180, 185, 190, 195, 200, 205, 210, 215, 220, 225, 230, 235,   // 67 - 78
+  240, 245, 250, 255, 260, 265, 270, 275, 280, 285, 290, 295,   // 79 - 90
+  301, 305, 311, 315, 320, 325, 330, 335, 340, 345, 350, 355,   // 91 - 102
+  360, 365, 372, 375, 380, 387, 390, 395, 400, 405, 410, 415,   // 103 - 114
+  420, 425, 430, 435, 440, 445, 450, 456, 461, 467, 471, 475   // 115 - 126
+};
+
+// tighten a few of the usual pairs (left, right, adjust)
+static const signed char _Prop5x7Kerning [] PROGMEM =
+{
+  'T', 'a', -1,
+  'T', 'e', -1,
+  'T', 'o', -1,
+  'V', 'a', -1,
+  'V', 'o', -1,
+  'Y', 'o', -1,
+  'L', 'T', -1,
+  'L', 'V', -1,
+  0
+};
+
+const SSD1306_Font SSD1306_FontProp5x7 PROGMEM =
+{
+  31, 126,    // first / last character
+  8, 3, 1,    // height, nominal width, spacing
+  _Prop5x7Widths,
+  _Prop5x7Offsets,
+  _CharMap,
+  _Prop5x7Kerning
+};
+
+// 16 px numeric face, ceil(16 / 8) = 2 rows of column bytes per glyph
+static const unsigned char _Num16Bits [] PROGMEM =
+{
+  // '-'
+  0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00,
+  0x00, 0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00, 0x00,
+  // '.'
+  0x00, 0x00,
+  0xC0, 0xC0,
+  // '/' (no glyph)
+  // '0'
+  0x7C, 0x7C, 0x03, 0x03, 0x03, 0x03, 0x03, 0x7C, 0x7C,
+  0x3E, 0x3E, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0x3E, 0x3E,
+  // '1'
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7C, 0x7C,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3E, 0x3E,
+  // '2'
+  0x00, 0x00, 0x83, 0x83, 0x83, 0x83, 0x83, 0x7C, 0x7C,
+  0x3E, 0x3E, 0xC1, 0xC1, 0xC1, 0xC1, 0xC1, 0x00, 0x00,
+  // '3'
+  0x00, 0x00, 0x83, 0x83, 0x83, 0x83, 0x83, 0x7C, 0x7C,
+  0x00, 0x00, 0xC1, 0xC1, 0xC1, 0xC1, 0xC1, 0x3E, 0x3E,
+  // '4'
+  0x7C, 0x7C, 0x80, 0x80, 0x80, 0x80, 0x80, 0x7C, 0x7C,
+  0x00, 0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x3E, 0x3E,
+  // '5'
+  0x7C, 0x7C, 0x83, 0x83, 0x83, 0x83, 0x83, 0x00, 0x00,
+  0x00, 0x00, 0xC1, 0xC1, 0xC1, 0xC1, 0xC1, 0x3E, 0x3E,
+  // '6'
+  0x7C, 0x7C, 0x83, 0x83, 0x83, 0x83, 0x83, 0x00, 0x00,
+  0x3E, 0x3E, 0xC1, 0xC1, 0xC1, 0xC1, 0xC1, 0x3E, 0x3E,
+  // '7'
+  0x00, 0x00, 0x03, 0x03, 0x03, 0x03, 0x03, 0x7C, 0x7C,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3E, 0x3E,
+  // '8'
+  0x7C, 0x7C, 0x83, 0x83, 0x83, 0x83, 0x83, 0x7C, 0x7C,
+  0x3E, 0x3E, 0xC1, 0xC1, 0xC1, 0xC1, 0xC1, 0x3E, 0x3E,
+  // '9'
+  0x7C, 0x7C, 0x83, 0x83, 0x83, 0x83, 0x83, 0x7C, 0x7C,
+  0x00, 0x00, 0xC1, 0xC1, 0xC1, 0xC1, 0xC1, 0x3E, 0x3E,
+  // ':'
+  0x30, 0x30,
+  0x0C, 0x0C
+};
+
+static const unsigned char _Num16Widths [14] PROGMEM =
+{
+  9, 2, 0, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 2   // - . / 0 - 9 :
+};
+
+static const unsigned int _Num16Offsets [14] PROGMEM =
+{
+  0, 18, 22, 22, 40, 58, 76, 94, 112, 130, 148, 166, 184, 202
+};
+
+// 24 px numeric face, ceil(24 / 8) = 3 rows of column bytes per glyph
+static const unsigned char _Num24Bits [] PROGMEM =
+{
+  // '-'
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x18, 0x3C, 0x3C, 0x3C, 0x3C, 0x18, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  // '.'
+  0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00,
+  0xE0, 0xE0, 0xE0,
+  // '/' (no glyph)
+  // '0'
+  0xF8, 0xFC, 0xFA, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0xFA, 0xFC, 0xF8,
+  0xE7, 0xE7, 0xC3, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC3, 0xE7, 0xE7,
+  0x1F, 0x3F, 0x5F, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0x5F, 0x3F, 0x1F,
+  // '1'
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8, 0xFC, 0xF8,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC3, 0xE7, 0xE7,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x3F, 0x1F,
+  // '2'
+  0x00, 0x00, 0x02, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0xFA, 0xFC, 0xF8,
+  0xE0, 0xE0, 0xC0, 0x18, 0x3C, 0x3C, 0x3C, 0x3C, 0x18, 0x03, 0x07, 0x07,
+  0x1F, 0x3F, 0x5F, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0x40, 0x00, 0x00,
+  // '3'
+  0x00, 0x00, 0x02, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0xFA, 0xFC, 0xF8,
+  0x00, 0x00, 0x00, 0x18, 0x3C, 0x3C, 0x3C, 0x3C, 0x18, 0xC3, 0xE7, 0xE7,
+  0x00, 0x00, 0x40, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0x5F, 0x3F, 0x1F,
+  // '4'
+  0xF8, 0xFC, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8, 0xFC, 0xF8,
+  0x07, 0x07, 0x03, 0x18, 0x3C, 0x3C, 0x3C, 0x3C, 0x18, 0xC3, 0xE7, 0xE7,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x3F, 0x1F,
+  // '5'
+  0xF8, 0xFC, 0xFA, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x02, 0x00, 0x00,
+  0x07, 0x07, 0x03, 0x18, 0x3C, 0x3C, 0x3C, 0x3C, 0x18, 0xC0, 0xE0, 0xE0,
+  0x00, 0x00, 0x40, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0x5F, 0x3F, 0x1F,
+  // '6'
+  0xF8, 0xFC, 0xFA, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x02, 0x00, 0x00,
+  0xE7, 0xE7, 0xC3, 0x18, 0x3C, 0x3C, 0x3C, 0x3C, 0x18, 0xC0, 0xE0, 0xE0,
+  0x1F, 0x3F, 0x5F, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0x5F, 0x3F, 0x1F,
+  // '7'
+  0x00, 0x00, 0x02, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0xFA, 0xFC, 0xF8,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC3, 0xE7, 0xE7,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x3F, 0x1F,
+  // '8'
+  0xF8, 0xFC, 0xFA, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0xFA, 0xFC, 0xF8,
+  0xE7, 0xE7, 0xC3, 0x18, 0x3C, 0x3C, 0x3C, 0x3C, 0x18, 0xC3, 0xE7, 0xE7,
+  0x1F, 0x3F, 0x5F, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0x5F, 0x3F, 0x1F,
+  // '9'
+  0xF8, 0xFC, 0xFA, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0xFA, 0xFC, 0xF8,
+  0x07, 0x07, 0x03, 0x18, 0x3C, 0x3C, 0x3C, 0x3C, 0x18, 0xC3, 0xE7, 0xE7,
+  0x00, 0x00, 0x40, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0xE0, 0x5F, 0x3F, 0x1F,
+  // ':'
+  0xC0, 0xC0, 0xC0,
+  0x01, 0x01, 0x01,
+  0x07, 0x07, 0x07
+};
+
+static const unsigned char _Num24Widths [14] PROGMEM =
+{
+  12, 3, 0, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 3   // - . / 0 - 9 :
+};
+
+static const unsigned int _Num24Offsets [14] PROGMEM =
+{
+  0, 36, 45, 45, 81, 117, 153, 189, 225, 261, 297, 333, 369, 405
+};
+
+// 32 px numeric face, ceil(32 / 8) = 4 rows of column bytes per glyph
+static const unsigned char _Num32Bits [] PROGMEM =
+{
+  // '-'
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x80, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0x80, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x01, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x01, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  // '.'
+  0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00,
+  0xF0, 0xF0, 0xF0, 0xF0,
+  // '/' (no glyph)
+  // '0'
+  0xF0, 0xF8, 0xF8, 0xF6, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0xF6, 0xF8, 0xF8, 0xF0,
+  0x3F, 0x7F, 0x7F, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x7F, 0x7F, 0x3F,
+  0xFC, 0xFE, 0xFE, 0xFC, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFC, 0xFE, 0xFE, 0xFC,
+  0x0F, 0x1F, 0x1F, 0x6F, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0x6F, 0x1F, 0x1F, 0x0F,
+  // '1'
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xF8, 0xF8, 0xF0,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x7F, 0x7F, 0x3F,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFC, 0xFE, 0xFE, 0xFC,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x1F, 0x1F, 0x0F,
+  // '2'
+  0x00, 0x00, 0x00, 0x06, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0xF6, 0xF8, 0xF8, 0xF0,
+  0x00, 0x00, 0x00, 0x80, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xBF, 0x7F, 0x7F, 0x3F,
+  0xFC, 0xFE, 0xFE, 0xFD, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x01, 0x00, 0x00, 0x00,
+  0x0F, 0x1F, 0x1F, 0x6F, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0x60, 0x00, 0x00, 0x00,
+  // '3'
+  0x00, 0x00, 0x00, 0x06, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0xF6, 0xF8, 0xF8, 0xF0,
+  0x00, 0x00, 0x00, 0x80, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xBF, 0x7F, 0x7F, 0x3F,
+  0x00, 0x00, 0x00, 0x01, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0xFD, 0xFE, 0xFE, 0xFC,
+  0x00, 0x00, 0x00, 0x60, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0x6F, 0x1F, 0x1F, 0x0F,
+  // '4'
+  0xF0, 0xF8, 0xF8, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xF8, 0xF8, 0xF0,
+  0x3F, 0x7F, 0x7F, 0xBF, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xBF, 0x7F, 0x7F, 0x3F,
+  0x00, 0x00, 0x00, 0x01, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0xFD, 0xFE, 0xFE, 0xFC,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x1F, 0x1F, 0x0F,
+  // '5'
+  0xF0, 0xF8, 0xF8, 0xF6, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x06, 0x00, 0x00, 0x00,
+  0x3F, 0x7F, 0x7F, 0xBF, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0x80, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x01, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0xFD, 0xFE, 0xFE, 0xFC,
+  0x00, 0x00, 0x00, 0x60, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0x6F, 0x1F, 0x1F, 0x0F,
+  // '6'
+  0xF0, 0xF8, 0xF8, 0xF6, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x06, 0x00, 0x00, 0x00,
+  0x3F, 0x7F, 0x7F, 0xBF, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0x80, 0x00, 0x00, 0x00,
+  0xFC, 0xFE, 0xFE, 0xFD, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0xFD, 0xFE, 0xFE, 0xFC,
+  0x0F, 0x1F, 0x1F, 0x6F, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0x6F, 0x1F, 0x1F, 0x0F,
+  // '7'
+  0x00, 0x00, 0x00, 0x06, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0xF6, 0xF8, 0xF8, 0xF0,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x7F, 0x7F, 0x3F,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFC, 0xFE, 0xFE, 0xFC,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x1F, 0x1F, 0x0F,
+  // '8'
+  0xF0, 0xF8, 0xF8, 0xF6, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0xF6, 0xF8, 0xF8, 0xF0,
+  0x3F, 0x7F, 0x7F, 0xBF, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xBF, 0x7F, 0x7F, 0x3F,
+  0xFC, 0xFE, 0xFE, 0xFD, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0xFD, 0xFE, 0xFE, 0xFC,
+  0x0F, 0x1F, 0x1F, 0x6F, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0x6F, 0x1F, 0x1F, 0x0F,
+  // '9'
+  0xF0, 0xF8, 0xF8, 0xF6, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0xF6, 0xF8, 0xF8, 0xF0,
+  0x3F, 0x7F, 0x7F, 0xBF, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xBF, 0x7F, 0x7F, 0x3F,
+  0x00, 0x00, 0x00, 0x01, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0xFD, 0xFE, 0xFE, 0xFC,
+  0x00, 0x00, 0x00, 0x60, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0x6F, 0x1F, 0x1F, 0x0F,
+  // ':'
+  0x80, 0x80, 0x80, 0x80,
+  0x07, 0x07, 0x07, 0x07,
+  0xE0, 0xE0, 0xE0, 0xE0,
+  0x01, 0x01, 0x01, 0x01
+};
+
+static const unsigned char _Num32Widths [14] PROGMEM =
+{
+  16, 4, 0, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 4   // - . / 0 - 9 :
+};
+
+static const unsigned int _Num32Offsets [14] PROGMEM =
+{
+  0, 64, 80, 80, 144, 208, 272, 336, 400, 464, 528, 592, 656, 720
+};
+
+const SSD1306_Font SSD1306_FontNum16 PROGMEM =
+{
+  '-', ':',   // first / last character
+  16, 9, 2,   // height, nominal width (space), spacing
+  _Num16Widths,
+  _Num16Offsets,
+  _Num16Bits,
+  NULL        // tabular digits, no kerning
+};
+
+const SSD1306_Font SSD1306_FontNum24 PROGMEM =
+{
+  '-', ':',   // first / last character
+  24, 12, 2,   // height, nominal width (space), spacing
+  _Num24Widths,
+  _Num24Offsets,
+  _Num24Bits,
+  NULL        // tabular digits, no kerning
+};
+
+const SSD1306_Font SSD1306_FontNum32 PROGMEM =
+{
+  '-', ':',   // first / last character
+  32, 16, 3,   // height, nominal width (space), spacing
+  _Num32Widths,
+  _Num32Offsets,
+  _Num32Bits,
+  NULL        // tabular digits, no kerning
+};
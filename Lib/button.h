@@ -0,0 +1,64 @@
+// Button library, ATmega328P Version
+// Revision History:
+// Oct 2026 - Initial Build, pin change wake-up, vertical counter debounce,
+//             event queue
+// Oct 2026 - Button_Retime for Timer1 count rate changes (clock.h)
+// Oct 2026 - Button_SetCallback, an event queued can release a task (sched.h)
+
+// buttons are on port B, active low (pull-ups on, pressed pulls to ground)
+// a pin change (PCINT0) starts a fast tick on Timer1 compare B, which
+//  samples all the buttons at once through a 2-bit vertical counter (4
+//  equal samples to change, 8ms at the default 2ms tick), and stops again
+//  once everything is released and settled, so there is no cost at rest
+// one hold timer is shared by all the buttons, so the tick costs the same
+//  however many there are (long press / repeat are for whatever is held)
+// the library owns TIMER1_COMPB_vect and PCINT0_vect (Timer1 must be set
+//  up with Timer_Init / Timer_SetCpuClock first)
+
+#ifndef BUTTON_TICK_US
+#define BUTTON_TICK_US 2000     // debounce sample period
+#endif
+#ifndef BUTTON_LONG_TICKS
+#define BUTTON_LONG_TICKS 400   // held this long for Button_Long (800ms)
+#endif
+#ifndef BUTTON_REPEAT_TICKS
+#define BUTTON_REPEAT_TICKS 100 // then Button_Repeat this often (200ms)
+#endif
+
+typedef enum Button_Type
+{
+	Button_Press,
+	Button_Release,
+	Button_Long,
+	Button_Repeat
+} Button_Type;
+
+// one event covers every button it happened to on the same tick
+typedef struct Button_Event
+{
+	Button_Type type;
+	unsigned char ucMask;   // port B bits
+} Button_Event;
+
+// buttons on the port B bits in ucMask (inputs with pull-ups), long press
+//  and repeat only for the bits in ucRepeat
+void Button_Init (unsigned char ucMask, unsigned char ucRepeat);
+
+// work the tick out again after Timer_Hz has changed
+void Button_Retime (void);
+
+// pCallback runs in the tick ISR each time an event is queued (NULL for none)
+typedef void (*Button_Callback)(void);
+void Button_SetCallback (Button_Callback pCallback);
+
+// take the oldest event, returns 0 if there is none
+int Button_Get (Button_Event * pEvent);
+
+// debounced state, a bit set for each button down
+unsigned char Button_State (void);
+
+// the debounce tick is running (Timer1 has to keep its clock, no power-save)
+int Button_Busy (void);
+
+// events lost to a full queue since the last call
+unsigned char Button_Dropped (void);
@@ -0,0 +1,195 @@
+// Button Library
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include "timer.h"
+#include "button.h"
+
+// event queue (power of two entries)
+#define BUTTON_QUEUE 8
+static volatile Button_Event _Button_Queue [BUTTON_QUEUE];
+static volatile unsigned char _ucButton_Head = 0;   // written by ISR
+static volatile unsigned char _ucButton_Tail = 0;   // written by reader
+static volatile unsigned char _ucButton_Dropped = 0;
+
+static unsigned char _ucButton_Mask = 0;
+static unsigned char _ucButton_Repeat = 0;
+static unsigned int _uiButton_Period = 0;   // Timer1 counts per tick
+static Button_Callback _pButton_Callback = 0;
+
+// debounced state and the vertical counter, bit n of Ct1:Ct0 is the
+//  2-bit count for pin n, it only runs while the pin differs from State
+static volatile unsigned char _ucButton_State = 0;
+static unsigned char _ucButton_Ct0 = 0xFF;
+static unsigned char _ucButton_Ct1 = 0xFF;
+
+// ticks since the debounced state last changed
+static unsigned int _uiButton_Hold = 0;
+
+static void Button_Put (Button_Type type, unsigned char ucMask)
+{
+	unsigned char ucNext = (_ucButton_Head + 1) & (BUTTON_QUEUE - 1);
+
+	if (ucNext == _ucButton_Tail)
+	{
+		if (_ucButton_Dropped != 0xFF)
+			++_ucButton_Dropped;
+		return;
+	}
+	_Button_Queue[_ucButton_Head].type = type;
+	_Button_Queue[_ucButton_Head].ucMask = ucMask;
+	_ucButton_Head = ucNext;
+	if (_pButton_Callback)
+		_pButton_Callback();
+}
+
+// start sampling, the pin change interrupt is off until we settle again
+//  (no point taking every bounce)
+// must be called with interrupts off
+static void Button_Wake (void)
+{
+	PCICR &= ~(1 << PCIE0);
+	OCR1B = TCNT1 + _uiButton_Period;
+	TIFR1 = 1 << OCF1B;
+	TIMSK1 |= 1 << OCIE1B;
+}
+
+// Timer1 counts per tick
+static unsigned int Button_Period (void)
+{
+	unsigned int uiPeriod = (unsigned long)Timer_Hz() * BUTTON_TICK_US / 1000000;
+
+	return uiPeriod ? uiPeriod : 1;
+}
+
+void Button_Init (unsigned char ucMask, unsigned char ucRepeat)
+{
+	// inputs with pull-ups
+	DDRB &= ~ucMask;
+	PORTB |= ucMask;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		_ucButton_Mask = ucMask;
+		_ucButton_Repeat = ucRepeat;
+		_uiButton_Period = Button_Period();
+
+		_ucButton_Head = _ucButton_Tail = 0;
+		_ucButton_Dropped = 0;
+		_ucButton_State = 0;
+		_ucButton_Ct0 = _ucButton_Ct1 = 0xFF;
+		_uiButton_Hold = 0;
+
+		PCMSK0 = ucMask;
+		Button_Wake();  // pick up anything already held
+	}
+}
+
+void Button_Retime (void)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		_uiButton_Period = Button_Period();
+	}
+}
+
+void Button_SetCallback (Button_Callback pCallback)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		_pButton_Callback = pCallback;
+	}
+}
+
+int Button_Get (Button_Event * pEvent)
+{
+	unsigned char ucTail = _ucButton_Tail;
+
+	if (ucTail == _ucButton_Head)
+		return 0;
+
+	// only the ISR writes at head, so the entry is stable once published
+	pEvent->type = _Button_Queue[ucTail].type;
+	pEvent->ucMask = _Button_Queue[ucTail].ucMask;
+	_ucButton_Tail = (ucTail + 1) & (BUTTON_QUEUE - 1);
+	return 1;
+}
+
+unsigned char Button_State (void)
+{
+	return _ucButton_State;
+}
+
+int Button_Busy (void)
+{
+	return (TIMSK1 & (1 << OCIE1B)) != 0;
+}
+
+unsigned char Button_Dropped (void)
+{
+	unsigned char ucDropped;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		ucDropped = _ucButton_Dropped;
+		_ucButton_Dropped = 0;
+	}
+	return ucDropped;
+}
+
+// debounce tick, every button in one pass
+ISR(TIMER1_COMPB_vect)
+{
+	unsigned char ucRaw = ~PINB & _ucButton_Mask;
+	unsigned char ucChanged = ucRaw ^ _ucButton_State;
+
+	OCR1B += _uiButton_Period;
+
+	// count the pins that differ from the debounced state, reset the rest,
+	//  a pin whose count rolls over (4 samples) toggles its state
+	_ucButton_Ct0 = ~(_ucButton_Ct0 & ucChanged);
+	_ucButton_Ct1 = _ucButton_Ct0 ^ (_ucButton_Ct1 & ucChanged);
+	ucChanged &= _ucButton_Ct0 & _ucButton_Ct1;
+	_ucButton_State ^= ucChanged;
+
+	if (ucChanged)
+	{
+		if (_ucButton_State & ucChanged)
+			Button_Put(Button_Press, _ucButton_State & ucChanged);
+		if (~_ucButton_State & ucChanged)
+			Button_Put(Button_Release, ~_ucButton_State & ucChanged);
+		_uiButton_Hold = 0;
+	}
+	else if (_ucButton_State & _ucButton_Repeat)
+	{
+		// long press once, then repeats, for whatever repeat button is held
+		if (++_uiButton_Hold == BUTTON_LONG_TICKS)
+			Button_Put(Button_Long, _ucButton_State & _ucButton_Repeat);
+		else if (_uiButton_Hold == BUTTON_LONG_TICKS + BUTTON_REPEAT_TICKS)
+		{
+			Button_Put(Button_Repeat, _ucButton_State & _ucButton_Repeat);
+			_uiButton_Hold = BUTTON_LONG_TICKS;
+		}
+	}
+
+	// all up and settled, go back to waiting on a pin change
+	if (!_ucButton_State && !ucRaw)
+	{
+		PCIFR = 1 << PCIF0;
+		PCICR |= 1 << PCIE0;
+
+		// a press after our sample but before the flag was cleared would be
+		//  lost, look again now that the interrupt is armed
+		if (!(~PINB & _ucButton_Mask))
+			TIMSK1 &= ~(1 << OCIE1B);
+		else
+			PCICR &= ~(1 << PCIE0);
+	}
+}
+
+// pin change, a button moved, start sampling
+ISR(PCINT0_vect)
+{
+	Button_Wake();
+}
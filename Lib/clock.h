@@ -0,0 +1,53 @@
+// Clock library, ATmega328P Version
+// Revision History:
+// Oct 2026 - Initial Build, owns CLKPR, moves Timer1, the TWI bit rate and
+//             the delays along with the CPU clock
+// Oct 2026 - Waits out an interrupt driven TWI write before a change
+
+// the CPU clock is the source (crystal or internal RC) divided by CLKPR
+// Clock_Set changes the divider at runtime and, with interrupts off, puts
+//  right everything that counts CPU clocks:
+//   Timer1 (Timer_SetCpuClock): the same count rate if another prescale
+//    gives it, so time and the service tick carry on untouched, otherwise
+//    Timer_Micros is rebased and the service tick offset scaled
+//   TWI (I2C_SetBusRate): TWBR / TWPS for the SCL rate given to I2C_Init,
+//    or the fastest rate under it (100kHz can't be had below 1.6MHz), and
+//    the bit timing of the software I2C buses. An interrupt driven TWI
+//    write (I2C_WriteAsync) is let finish first
+//   Clock_DelayUs / Clock_DelayMs
+//  then calls the app back for the rest (UART baud, button tick, ...)
+// don't change the clock in the middle of an I2C transaction or while the
+//  UART is sending (UART_Busy), the byte on the wire would be garbled
+// nothing in the libraries uses F_CPU, pass Clock_Hz() to the inits
+
+typedef enum Clock_Div
+{
+	Clock_Div_1 = 0,
+	Clock_Div_2 = 1,
+	Clock_Div_4 = 2,
+	Clock_Div_8 = 3,
+	Clock_Div_16 = 4,
+	Clock_Div_32 = 5,
+	Clock_Div_64 = 6,
+	Clock_Div_128 = 7,
+	Clock_Div_256 = 8
+} Clock_Div;
+
+// called after a change, with the new CPU clock in Hz
+typedef void (*Clock_Callback)(unsigned long ulCpuHz);
+
+// set the first divider, call before any other init
+// ulSourceHz is the oscillator (16MHz crystal, 8MHz RC, ...), pCallback
+//  may be NULL
+void Clock_Init (unsigned long ulSourceHz, Clock_Div div, Clock_Callback pCallback);
+
+// change the divider, returns -1 for a bad divider, 0 otherwise
+int Clock_Set (Clock_Div div);
+
+// CPU clock in Hz
+unsigned long Clock_Hz (void);
+
+// busy wait at least this long at the current clock (longer if interrupts
+//  run in between), for the odd setup delay, don't use them for timing
+void Clock_DelayUs (unsigned int uiUs);
+void Clock_DelayMs (unsigned int uiMs);
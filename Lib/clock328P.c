@@ -0,0 +1,82 @@
+// Clock Library
+
+#include <avr/io.h>
+#include <avr/power.h>
+#include <util/atomic.h>
+#include <util/delay_basic.h>
+#include "timer.h"
+#include "I2C.h"
+#include "clock.h"
+
+static unsigned long _ulClock_SourceHz = 0;
+static unsigned long _ulClock_Hz = 0;
+static Clock_Callback _pClock_Callback = 0;
+
+// _delay_loop_2 passes (4 clocks each) in a millisecond
+static unsigned int _uiClock_LoopsMs = 1;
+
+static void Clock_Apply (Clock_Div div)
+{
+	// the timed CLKPCE sequence (4 clocks) is done in assembly by avr-libc
+	clock_prescale_set((clock_div_t)div);
+	_ulClock_Hz = _ulClock_SourceHz >> div;
+	_uiClock_LoopsMs = _ulClock_Hz / 4000;
+	if (!_uiClock_LoopsMs)
+		_uiClock_LoopsMs = 1;
+}
+
+void Clock_Init (unsigned long ulSourceHz, Clock_Div div, Clock_Callback pCallback)
+{
+	_ulClock_SourceHz = ulSourceHz;
+	_pClock_Callback = pCallback;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		Clock_Apply(div);
+	}
+}
+
+int Clock_Set (Clock_Div div)
+{
+	if (div > Clock_Div_256)
+		return -1;
+
+	// an interrupt driven TWI write finishes at the rate it started at
+	while (I2C_Busy())
+		;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		Clock_Apply(div);
+		Timer_SetCpuClock(_ulClock_Hz);
+		I2C_SetBusRate(_ulClock_Hz);
+	}
+
+	if (_pClock_Callback)
+		_pClock_Callback(_ulClock_Hz);
+	return 0;
+}
+
+unsigned long Clock_Hz (void)
+{
+	return _ulClock_Hz;
+}
+
+void Clock_DelayUs (unsigned int uiUs)
+{
+	// round up, a delay is a minimum
+	unsigned long ulLoops = ((unsigned long)uiUs * _uiClock_LoopsMs + 999) / 1000;
+
+	while (ulLoops > 0xFFFF)
+	{
+		_delay_loop_2(0xFFFF);
+		ulLoops -= 0xFFFF;
+	}
+	if (ulLoops)
+		_delay_loop_2((unsigned int)ulLoops);
+}
+
+void Clock_DelayMs (unsigned int uiMs)
+{
+	while (uiMs--)
+		_delay_loop_2(_uiClock_LoopsMs);
+}
@@ -0,0 +1,88 @@
+// Console library, ATmega328P Version
+// Revision History:
+// Oct 2026 - Initial Build, text console over the PCF8574A LCD and the
+//             SSD1306 text grid as an avr-libc stream
+// Oct 2026 - An LCD row that fails to go out stays dirty for the next flush
+// Oct 2026 - The whole LCD shadow is sent again after the LCD resyncs
+//             (LCD_Syncs)
+
+// a console is a grid of character cells on a display (the backend) and a
+//  cursor, opened as a FILE, so the UI prints straight onto the display:
+//
+//   FILE * lcd = Console_Init (&_LcdConsole, &Console_Lcd, 0);
+//   Console_GotoXY (lcd, 0, 1);
+//   fprintf_P (lcd, PSTR("L%03u %s\n"), uiLap, pText);
+//   Console_Flush (lcd);
+//
+// characters go into the backend's shadow of the display (the LCD backend
+//  keeps one in RAM, the SSD1306 back-buffer is its own), only cells that
+//  change are marked, Console_Flush sends them: one transaction per row
+//  on the LCD, one render window on the OLED
+// control characters:
+//  '\n' clears to the end of the row and goes to the start of the next
+//  '\r' goes to the start of the row
+//  '\f' clears the region and goes home
+// a row is clipped at the right edge of the region (no wrap), past the
+//  last row nothing is written until the cursor is moved
+// the cursor and Console_GotoXY are relative to the region (Console_Region,
+//  the whole display to start with)
+
+#include <stdio.h>
+
+#ifndef CONSOLE_LCD_COLS
+#define CONSOLE_LCD_COLS 16   // PCF8574A LCD geometry
+#endif
+#ifndef CONSOLE_LCD_ROWS
+#define CONSOLE_LCD_ROWS 2
+#endif
+
+// what a display provides, a backend lives in flash
+typedef struct Console_Backend
+{
+	// grid size of the display behind pCtx
+	void (*pSize)(void * pCtx, unsigned char * pucCols, unsigned char * pucRows);
+	// one character into the shadow
+	void (*pPut)(void * pCtx, unsigned char ucX, unsigned char ucY, char c);
+	// changed cells out to the display
+	void (*pFlush)(void * pCtx);
+} Console_Backend;
+
+// the PCF8574A LCD, pCtx unused, the console opens on a cleared LCD
+extern const Console_Backend Console_Lcd;
+// the SSD1306 5x7 text grid (6 pixel columns, 8 pixel banks), pCtx is the
+//  SSD1306_Display, which is selected for each call
+extern const Console_Backend Console_Oled;
+
+typedef struct Console
+{
+	FILE Stream;                // the console as a stream
+	Console_Backend Ops;        // copy of the backend
+	void * pCtx;
+	unsigned char ucCols;       // display
+	unsigned char ucRows;
+	unsigned char ucLeft;       // region
+	unsigned char ucTop;
+	unsigned char ucWidth;
+	unsigned char ucHeight;
+	unsigned char ucX;          // cursor, in the region
+	unsigned char ucY;
+} Console;
+
+// open a console on a backend (PROGMEM), returns its stream
+FILE * Console_Init (Console * pCon, const Console_Backend * pBackend, void * pCtx);
+
+// move the cursor
+void Console_GotoXY (FILE * pStream, unsigned char ucX, unsigned char ucY);
+
+// spaces from the cursor to the end of the row, the cursor stays
+void Console_ClearEol (FILE * pStream);
+
+// spaces over the whole region, cursor home
+void Console_Clear (FILE * pStream);
+
+// restrict the console to ucWidth x ucHeight cells at ucLeft / ucTop
+//  (clipped to the display, 0 for the rest of it), cursor home
+void Console_Region (FILE * pStream, unsigned char ucLeft, unsigned char ucTop, unsigned char ucWidth, unsigned char ucHeight);
+
+// send what changed
+void Console_Flush (FILE * pStream);
@@ -0,0 +1,206 @@
+// Console Library
+
+#include <avr/pgmspace.h>
+#include <string.h>
+#include "PCF8574A.h"
+#include "SSD1306.h"
+#include "console.h"
+
+// LCD shadow: what the LCD shows once flushed, and the changed columns of
+//  each row, [Lo, End), clean when End == 0
+static char _acConsole_Lcd [CONSOLE_LCD_ROWS][CONSOLE_LCD_COLS];
+static struct
+{
+	unsigned char Lo;
+	unsigned char End;
+} _Console_LcdDirty [CONSOLE_LCD_ROWS];
+
+// LCD_Syncs as of the shadow, a resync clears the LCD
+static unsigned char _ucConsole_LcdSyncs = 0;
+
+// after a resync every row goes out again, whole
+static void Console_LcdSynced (void)
+{
+	if (LCD_Syncs() == _ucConsole_LcdSyncs)
+		return;
+
+	_ucConsole_LcdSyncs = LCD_Syncs();
+	for (unsigned char i = 0; i < CONSOLE_LCD_ROWS; ++i)
+	{
+		_Console_LcdDirty[i].Lo = 0;
+		_Console_LcdDirty[i].End = CONSOLE_LCD_COLS;
+	}
+}
+
+static void Console_LcdSize (void * pCtx, unsigned char * pucCols, unsigned char * pucRows)
+{
+	// opened on a cleared LCD
+	memset(_acConsole_Lcd, ' ', sizeof _acConsole_Lcd);
+	memset(_Console_LcdDirty, 0, sizeof _Console_LcdDirty);
+	_ucConsole_LcdSyncs = LCD_Syncs();
+	*pucCols = CONSOLE_LCD_COLS;
+	*pucRows = CONSOLE_LCD_ROWS;
+}
+
+static void Console_LcdPut (void * pCtx, unsigned char ucX, unsigned char ucY, char c)
+{
+	if (_acConsole_Lcd[ucY][ucX] == c)
+		return;
+
+	_acConsole_Lcd[ucY][ucX] = c;
+	if (!_Console_LcdDirty[ucY].End || ucX < _Console_LcdDirty[ucY].Lo)
+		_Console_LcdDirty[ucY].Lo = ucX;
+	if (ucX >= _Console_LcdDirty[ucY].End)
+		_Console_LcdDirty[ucY].End = ucX + 1;
+}
+
+static void Console_LcdFlush (void * pCtx)
+{
+	// clean cells inside a row's span are resent, cheaper than addressing twice
+	// a row that didn't go out stays dirty for the next flush
+	// a resync part way cleared the rows before it, go round once more
+	for (unsigned char ucPass = 0; ucPass < 2; ++ucPass)
+	{
+		Console_LcdSynced();
+		for (unsigned char i = 0; i < CONSOLE_LCD_ROWS; ++i)
+		{
+			unsigned char ucLo = _Console_LcdDirty[i].Lo;
+
+			if (!_Console_LcdDirty[i].End)
+				continue;
+			if (LCD_AddrXY(ucLo, i) || LCD_Chars(&_acConsole_Lcd[i][ucLo], _Console_LcdDirty[i].End - ucLo))
+				continue;
+			_Console_LcdDirty[i].End = 0;
+		}
+		if (LCD_Syncs() == _ucConsole_LcdSyncs)
+			break;
+	}
+	Console_LcdSynced();
+}
+
+const Console_Backend Console_Lcd PROGMEM = { Console_LcdSize, Console_LcdPut, Console_LcdFlush };
+
+static void Console_OledSize (void * pCtx, unsigned char * pucCols, unsigned char * pucRows)
+{
+	*pucCols = ((SSD1306_Display *)pCtx)->Width / 6;
+	*pucRows = ((SSD1306_Display *)pCtx)->Height / 8;
+}
+
+static void Console_OledPut (void * pCtx, unsigned char ucX, unsigned char ucY, char c)
+{
+	// the back-buffer is the shadow, a cell that doesn't change isn't marked
+	SSD1306_Select(pCtx);
+	SSD1306_CharXY(ucX, ucY, c);
+}
+
+static void Console_OledFlush (void * pCtx)
+{
+	SSD1306_Select(pCtx);
+	SSD1306_Render();
+}
+
+const Console_Backend Console_Oled PROGMEM = { Console_OledSize, Console_OledPut, Console_OledFlush };
+
+static void Console_Fill (Console * pCon, unsigned char ucY, unsigned char ucFrom)
+{
+	for (; ucFrom < pCon->ucWidth; ++ucFrom)
+		pCon->Ops.pPut(pCon->pCtx, pCon->ucLeft + ucFrom, pCon->ucTop + ucY, ' ');
+}
+
+static int Console_Put (char c, FILE * pStream)
+{
+	Console * pCon = fdev_get_udata(pStream);
+
+	switch (c)
+	{
+	case '\n':
+		if (pCon->ucY < pCon->ucHeight)
+		{
+			Console_Fill(pCon, pCon->ucY, pCon->ucX);
+			++pCon->ucY;
+		}
+		pCon->ucX = 0;
+		break;
+	case '\r':
+		pCon->ucX = 0;
+		break;
+	case '\f':
+		Console_Clear(pStream);
+		break;
+	default:
+		// clipped, the cursor still moves so the rest of the row is skipped
+		if (pCon->ucY < pCon->ucHeight && pCon->ucX < pCon->ucWidth)
+			pCon->Ops.pPut(pCon->pCtx, pCon->ucLeft + pCon->ucX, pCon->ucTop + pCon->ucY, c);
+		if (pCon->ucX < 0xFF)
+			++pCon->ucX;
+		break;
+	}
+	return 0;
+}
+
+FILE * Console_Init (Console * pCon, const Console_Backend * pBackend, void * pCtx)
+{
+	memcpy_P(&pCon->Ops, pBackend, sizeof pCon->Ops);
+	pCon->pCtx = pCtx;
+	pCon->Ops.pSize(pCtx, &pCon->ucCols, &pCon->ucRows);
+
+	fdev_setup_stream(&pCon->Stream, Console_Put, NULL, _FDEV_SETUP_WRITE);
+	fdev_set_udata(&pCon->Stream, pCon);
+
+	Console_Region(&pCon->Stream, 0, 0, 0, 0);
+	return &pCon->Stream;
+}
+
+void Console_GotoXY (FILE * pStream, unsigned char ucX, unsigned char ucY)
+{
+	Console * pCon = fdev_get_udata(pStream);
+
+	pCon->ucX = ucX;
+	pCon->ucY = ucY;
+}
+
+void Console_ClearEol (FILE * pStream)
+{
+	Console * pCon = fdev_get_udata(pStream);
+
+	if (pCon->ucY < pCon->ucHeight)
+		Console_Fill(pCon, pCon->ucY, pCon->ucX);
+}
+
+void Console_Clear (FILE * pStream)
+{
+	Console * pCon = fdev_get_udata(pStream);
+
+	for (unsigned char i = 0; i < pCon->ucHeight; ++i)
+		Console_Fill(pCon, i, 0);
+	pCon->ucX = 0;
+	pCon->ucY = 0;
+}
+
+void Console_Region (FILE * pStream, unsigned char ucLeft, unsigned char ucTop, unsigned char ucWidth, unsigned char ucHeight)
+{
+	Console * pCon = fdev_get_udata(pStream);
+
+	if (ucLeft > pCon->ucCols)
+		ucLeft = pCon->ucCols;
+	if (ucTop > pCon->ucRows)
+		ucTop = pCon->ucRows;
+	if (!ucWidth || ucWidth > pCon->ucCols - ucLeft)
+		ucWidth = pCon->ucCols - ucLeft;
+	if (!ucHeight || ucHeight > pCon->ucRows - ucTop)
+		ucHeight = pCon->ucRows - ucTop;
+
+	pCon->ucLeft = ucLeft;
+	pCon->ucTop = ucTop;
+	pCon->ucWidth = ucWidth;
+	pCon->ucHeight = ucHeight;
+	pCon->ucX = 0;
+	pCon->ucY = 0;
+}
+
+void Console_Flush (FILE * pStream)
+{
+	Console * pCon = fdev_get_udata(pStream);
+
+	pCon->Ops.pFlush(pCon->pCtx);
+}
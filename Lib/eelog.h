@@ -0,0 +1,44 @@
+// EEPROM log library, ATmega328P Version
+// Revision History:
+// Oct 2026 - Initial Build, wear leveled record ring over the whole EEPROM,
+//             writes queued in RAM and drained by the EE_READY interrupt
+
+// the EEPROM is one ring of 8-byte records (128 in the 1KB array), each
+//  record goes in the slot after the last, so every cell is written once
+//  every 128 records instead of one cell taking every write
+// a record holds a sequence number, a 32-bit value, a tag byte and a CRC-8
+//  check, the newest record is found at power up by its sequence number,
+//  and a record torn by a power loss fails its check and is skipped
+// EELog_Put only copies the record into a small RAM queue, the EE_READY
+//  interrupt writes it out a byte at a time (up to 3.4ms a byte), bytes
+//  already holding their value are skipped and a byte that only needs
+//  bits cleared or set is erased or written in the 1.8ms modes
+// the library owns EE_READY_vect, nothing else may write the EEPROM
+
+#ifndef EELOG_QUEUE
+#define EELOG_QUEUE 8   // records waiting to be written (power of two)
+#endif
+
+typedef struct EELog_Record
+{
+	unsigned long ulData;   // value stored
+	unsigned char ucTag;    // what it is, up to the app
+} EELog_Record;
+
+// find the newest record, blocks to read the whole EEPROM (about 1ms at
+//  8MHz), call once before anything else
+void EELog_Init (void);
+
+// queue a record to be written, returns 0 if the queue is full
+int EELog_Put (unsigned long ulData, unsigned char ucTag);
+
+// records held, written or queued (up to the size of the ring)
+unsigned int EELog_Count (void);
+
+// record uiAge (0 is the newest), queued records come from RAM, returns 0
+//  if there is no such record or it was torn
+// may wait for the byte being written to finish (up to 3.4ms)
+int EELog_Read (unsigned int uiAge, EELog_Record * pRecord);
+
+// records still being written (no power-save, EE_READY only wakes idle)
+int EELog_Busy (void);
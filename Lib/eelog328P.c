@@ -0,0 +1,242 @@
+// EEPROM Log Library
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include <util/crc16.h>
+#include "eelog.h"
+
+// record layout in EEPROM, little endian, written in this order
+//  0-1 sequence, 2-5 data, 6 tag, 7 check
+// a record torn part way through already has its new sequence number, it
+//  can't pass for the record it was overwriting
+#define EELOG_RECORD 8
+#define EELOG_SLOTS ((E2END + 1) / EELOG_RECORD)   // 128, fits the slot byte
+
+// CRC-8 seed, an erased (all 0xFF) slot never passes
+#define EELOG_CHECK 0x5A
+
+typedef struct EELog_Entry
+{
+	unsigned char ucSlot;
+	unsigned char aucByte [EELOG_RECORD];
+} EELog_Entry;
+
+// write queue, a record stays queued until its last byte is done, so a
+//  record is always either in RAM or whole in EEPROM
+static volatile EELog_Entry _EELog_Queue [EELOG_QUEUE];
+static volatile unsigned char _ucEELog_Head = 0;    // written by Put
+static volatile unsigned char _ucEELog_Tail = 0;    // written by ISR
+static unsigned char _ucEELog_Byte = 0;             // ISR, next byte of tail
+
+// next record to be put
+static unsigned char _ucEELog_Slot = 0;
+static unsigned int _uiEELog_Seq = 0;
+static unsigned int _uiEELog_Count = 0;
+
+static unsigned char EELog_Check (const unsigned char * pucByte)
+{
+	unsigned char ucCrc = EELOG_CHECK;
+
+	for (unsigned char i = 0; i < EELOG_RECORD - 1; ++i)
+		ucCrc = _crc8_ccitt_update(ucCrc, pucByte[i]);
+	return ucCrc;
+}
+
+// one byte, interrupts off and no write going
+static unsigned char EELog_ReadByte (unsigned int uiAddr)
+{
+	EEAR = uiAddr;
+	EECR |= 1 << EERE;
+	return EEDR;
+}
+
+// a whole slot, waits out the byte being written with interrupts on, the
+//  ISR can't start the next one while we have them off
+static void EELog_ReadSlot (unsigned char ucSlot, unsigned char * pucByte)
+{
+	unsigned int uiAddr = (unsigned int)ucSlot * EELOG_RECORD;
+	int bDone = 0;
+
+	while (!bDone)
+	{
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+		{
+			if (!(EECR & (1 << EEPE)))
+			{
+				for (unsigned char i = 0; i < EELOG_RECORD; ++i)
+					pucByte[i] = EELog_ReadByte(uiAddr + i);
+				bDone = 1;
+			}
+		}
+	}
+}
+
+static unsigned int EELog_Seq (const unsigned char * pucByte)
+{
+	return pucByte[0] | ((unsigned int)pucByte[1] << 8);
+}
+
+void EELog_Init (void)
+{
+	unsigned char aucByte [EELOG_RECORD];
+	unsigned int uiNewest = 0, uiOldest = 0;
+	unsigned char ucNewest = 0;
+	int bFound = 0;
+
+	// every sequence number held is within one ring of the newest, so a
+	//  signed difference orders them across the 16-bit wrap
+	for (unsigned char ucSlot = 0; ucSlot < EELOG_SLOTS; ++ucSlot)
+	{
+		EELog_ReadSlot(ucSlot, aucByte);
+		if (aucByte[7] != EELog_Check(aucByte))
+			continue;
+
+		unsigned int uiSeq = EELog_Seq(aucByte);
+		if (!bFound || (int)(uiSeq - uiNewest) > 0)
+		{
+			uiNewest = uiSeq;
+			ucNewest = ucSlot;
+		}
+		if (!bFound || (int)(uiSeq - uiOldest) < 0)
+			uiOldest = uiSeq;
+		bFound = 1;
+	}
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		_ucEELog_Head = _ucEELog_Tail = 0;
+		_ucEELog_Byte = 0;
+		if (bFound)
+		{
+			_ucEELog_Slot = (ucNewest + 1) % EELOG_SLOTS;
+			_uiEELog_Seq = uiNewest + 1;
+			_uiEELog_Count = uiNewest - uiOldest + 1;
+		}
+		else
+		{
+			_ucEELog_Slot = 0;
+			_uiEELog_Seq = 0;
+			_uiEELog_Count = 0;
+		}
+	}
+}
+
+int EELog_Put (unsigned long ulData, unsigned char ucTag)
+{
+	unsigned char ucHead = _ucEELog_Head;
+	unsigned char ucNext = (ucHead + 1) & (EELOG_QUEUE - 1);
+	unsigned char aucByte [EELOG_RECORD];
+
+	if (ucNext == _ucEELog_Tail)
+		return 0;
+
+	aucByte[0] = _uiEELog_Seq;
+	aucByte[1] = _uiEELog_Seq >> 8;
+	aucByte[2] = ulData;
+	aucByte[3] = ulData >> 8;
+	aucByte[4] = ulData >> 16;
+	aucByte[5] = ulData >> 24;
+	aucByte[6] = ucTag;
+	aucByte[7] = EELog_Check(aucByte);
+
+	// only the ISR reads at head, and not until head moves past it
+	_EELog_Queue[ucHead].ucSlot = _ucEELog_Slot;
+	for (unsigned char i = 0; i < EELOG_RECORD; ++i)
+		_EELog_Queue[ucHead].aucByte[i] = aucByte[i];
+	_ucEELog_Head = ucNext;
+
+	_ucEELog_Slot = (_ucEELog_Slot + 1) % EELOG_SLOTS;
+	++_uiEELog_Seq;
+	if (_uiEELog_Count < EELOG_SLOTS)
+		++_uiEELog_Count;
+
+	EECR |= 1 << EERIE;     // fires straight away if no write is going
+	return 1;
+}
+
+unsigned int EELog_Count (void)
+{
+	return _uiEELog_Count;
+}
+
+int EELog_Read (unsigned int uiAge, EELog_Record * pRecord)
+{
+	unsigned char aucByte [EELOG_RECORD];
+	int bQueued = 0;
+
+	if (uiAge >= _uiEELog_Count)
+		return 0;
+
+	// still queued, take it from RAM before the ISR can finish it
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		if (uiAge < ((_ucEELog_Head - _ucEELog_Tail) & (EELOG_QUEUE - 1)))
+		{
+			unsigned char ucAt = (_ucEELog_Head - 1 - uiAge) & (EELOG_QUEUE - 1);
+
+			for (unsigned char i = 0; i < EELOG_RECORD; ++i)
+				aucByte[i] = _EELog_Queue[ucAt].aucByte[i];
+			bQueued = 1;
+		}
+	}
+	if (!bQueued)
+		EELog_ReadSlot((_ucEELog_Slot + EELOG_SLOTS - 1 - uiAge) % EELOG_SLOTS, aucByte);
+
+	// torn, or an older record left where a torn one should be
+	if (aucByte[7] != EELog_Check(aucByte) || EELog_Seq(aucByte) != (unsigned int)(_uiEELog_Seq - 1 - uiAge))
+		return 0;
+
+	pRecord->ulData = aucByte[2] | ((unsigned long)aucByte[3] << 8) | ((unsigned long)aucByte[4] << 16) | ((unsigned long)aucByte[5] << 24);
+	pRecord->ucTag = aucByte[6];
+	return 1;
+}
+
+int EELog_Busy (void)
+{
+	return _ucEELog_Head != _ucEELog_Tail;
+}
+
+// EEPROM ready, start the next byte that needs writing
+ISR(EE_READY_vect)
+{
+	while (_ucEELog_Tail != _ucEELog_Head)
+	{
+		volatile EELog_Entry * pEntry = &_EELog_Queue[_ucEELog_Tail];
+		unsigned char ucOld, ucNew, ucMode;
+		unsigned int uiAddr;
+
+		// the last byte has finished, the record is whole in EEPROM
+		if (_ucEELog_Byte == EELOG_RECORD)
+		{
+			_ucEELog_Tail = (_ucEELog_Tail + 1) & (EELOG_QUEUE - 1);
+			_ucEELog_Byte = 0;
+			continue;
+		}
+
+		uiAddr = (unsigned int)pEntry->ucSlot * EELOG_RECORD + _ucEELog_Byte;
+		ucNew = pEntry->aucByte[_ucEELog_Byte++];
+		ucOld = EELog_ReadByte(uiAddr);
+		if (ucOld == ucNew)
+			continue;
+
+		// erase only sets bits, write only clears them (1.8ms), both need
+		//  the atomic erase and write (3.4ms)
+		if (ucNew == 0xFF)
+			ucMode = 1 << EEPM0;
+		else if ((ucOld & ucNew) == ucNew)
+			ucMode = 1 << EEPM1;
+		else
+			ucMode = 0;
+
+		EEAR = uiAddr;
+		EEDR = ucNew;
+		EECR = ucMode | (1 << EERIE);
+		EECR |= 1 << EEMPE;     // EEPE within 4 cycles of EEMPE
+		EECR |= 1 << EEPE;
+		return;
+	}
+
+	// drained, the interrupt would fire for as long as the EEPROM is ready
+	EECR &= ~(1 << EERIE);
+}
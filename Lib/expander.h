@@ -0,0 +1,65 @@
+// Input expander library, ATmega328P Version
+// Revision History:
+// Oct 2026 - Initial Build, PCF8574 / PCF8574A as 8 inputs, read only when
+//             its INT output says something changed
+// Oct 2026 - Transfers through I2C_Transact (STOP on failure, retries,
+//             health in Expander_Health)
+
+// the port is quasi-bidirectional: a pin written 1 is an input with a weak
+//  pull-up, written 0 it is driven low (the LCD backpack, PCF8574A.h, is
+//  the same part used as outputs)
+// the open-drain INT output goes low when an input differs from what was
+//  last read and is let go by the next read or write of the port, wire it
+//  to INT0 (PD2, pull-up on here). INT0 is level triggered, so it wakes the
+//  CPU from any sleep mode: the ISR masks it, notes the change and calls
+//  back (to release a task, sched.h), it doesn't touch the bus, which may
+//  be in the middle of a transaction. Expander_Poll does the single byte
+//  read outside interrupts and unmasks INT0 again
+// nothing goes on the bus while the inputs stay as they are
+// the library owns INT0_vect
+
+#ifndef EXPANDER_ADDR
+#define EXPANDER_ADDR 0x20    // PCF8574, A2..A0 low (a PCF8574A is 0x38)
+#endif
+
+// one poll's worth of changes
+typedef struct Expander_Event
+{
+	unsigned char ucState;    // port as read
+	unsigned char ucChanged;  // bits that differ from the read before
+} Expander_Event;
+
+struct I2C_Bus;
+
+// the expander at uc7Addr on a bus (I2C.h, I2C_HW for the TWI), ucPort is
+//  written first (1s for inputs), then read as the starting state
+// returns -1 if it didn't answer (INT0 is on all the same, try
+//  Expander_Poll later)
+int Expander_Init (struct I2C_Bus * pBus, unsigned char uc7Addr, unsigned char ucPort);
+
+// pCallback runs in the INT0 ISR when INT goes low (NULL for none)
+typedef void (*Expander_Callback)(void);
+void Expander_SetCallback (Expander_Callback pCallback);
+
+// INT has gone low since the last poll
+int Expander_Pending (void);
+
+// if INT went low, read the port and unmask INT0
+// returns 1 with pEvent filled in if an input changed, 0 if nothing did (or
+//  nothing was pending), -1 if the read failed (still pending, poll again)
+int Expander_Poll (Expander_Event * pEvent);
+
+// raw port access (a keypad scan, keypad.h), a write or read lets INT go,
+//  and the scan's own edges raise it: Expander_Hold masks INT0 first, and
+//  the next Expander_Poll reads (whatever INT did) and unmasks it
+// returns -1 if the transfer failed (or the expander is offline)
+void Expander_Hold (void);
+int Expander_Write (unsigned char ucPort);
+int Expander_Read (unsigned char * pucPort);
+
+// I2C_Ok, I2C_Degraded or I2C_Offline (I2C.h), an offline expander costs
+//  nothing on the bus but a probe now and then
+int Expander_Health (void);
+
+// port as last read
+unsigned char Expander_State (void);
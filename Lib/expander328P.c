@@ -0,0 +1,141 @@
+// Input Expander Library
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include "I2C.h"
+#include "expander.h"
+
+static I2C_Bus * _pExpander_Bus = I2C_HW;
+static unsigned char _ucExpander_Addr = EXPANDER_ADDR;
+static unsigned char _ucExpander_State = 0xFF;
+static volatile unsigned char _ucExpander_Pending = 0;
+static Expander_Callback _pExpander_Callback = 0;
+
+// failed transactions in a row (I2C_Transact)
+static unsigned char _ucExpander_Health = 0;
+
+static int Expander_WriteXfer (I2C_Bus * pBus, unsigned char uc7Addr, void * pCtx)
+{
+	int iRet = I2C_BusStart(pBus, uc7Addr, I2C_WRITE);
+
+	if (iRet)
+		return iRet;
+
+	return I2C_BusWrite8(pBus, *(unsigned char *)pCtx, I2C_STOP);
+}
+
+static int Expander_ReadXfer (I2C_Bus * pBus, unsigned char uc7Addr, void * pCtx)
+{
+	int iRet = I2C_BusStart(pBus, uc7Addr, I2C_READ);
+
+	if (iRet)
+		return iRet;
+
+	return I2C_BusRead8(pBus, pCtx, I2C_NACK, I2C_STOP);
+}
+
+int Expander_Write (unsigned char ucPort)
+{
+	if (I2C_Transact(_pExpander_Bus, _ucExpander_Addr, &_ucExpander_Health, Expander_WriteXfer, &ucPort))
+		return -1;
+	return 0;
+}
+
+int Expander_Read (unsigned char * pucPort)
+{
+	if (I2C_Transact(_pExpander_Bus, _ucExpander_Addr, &_ucExpander_Health, Expander_ReadXfer, pucPort))
+		return -1;
+	return 0;
+}
+
+int Expander_Health (void)
+{
+	return I2C_State(_ucExpander_Health);
+}
+
+int Expander_Init (I2C_Bus * pBus, unsigned char uc7Addr, unsigned char ucPort)
+{
+	int iRet = 0;
+
+	_pExpander_Bus = pBus;
+	_ucExpander_Addr = uc7Addr;
+	_ucExpander_Health = 0;
+
+	// INT0 on PD2, input with pull-up, low level, masked for now
+	EIMSK &= ~(1 << INT0);
+	DDRD &= ~(1 << PORTD2);
+	PORTD |= 1 << PORTD2;
+	EICRA &= ~((1 << ISC01) | (1 << ISC00));
+
+	if (Expander_Write(ucPort) || Expander_Read(&_ucExpander_State))
+		iRet = -1;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		// a failed start leaves INT to the first poll
+		_ucExpander_Pending = iRet != 0;
+		if (!iRet)
+			EIMSK |= 1 << INT0;
+	}
+	return iRet;
+}
+
+void Expander_SetCallback (Expander_Callback pCallback)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		_pExpander_Callback = pCallback;
+	}
+}
+
+void Expander_Hold (void)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		EIMSK &= ~(1 << INT0);
+		_ucExpander_Pending = 1;
+	}
+}
+
+int Expander_Pending (void)
+{
+	return _ucExpander_Pending;
+}
+
+int Expander_Poll (Expander_Event * pEvent)
+{
+	unsigned char ucPort;
+
+	if (!_ucExpander_Pending)
+		return 0;
+
+	// the read lets INT go, INT0 stays masked if it failed
+	if (Expander_Read(&ucPort))
+		return -1;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		_ucExpander_Pending = 0;
+		EIMSK |= 1 << INT0;   // fires again straight away if there is more
+	}
+
+	pEvent->ucState = ucPort;
+	pEvent->ucChanged = ucPort ^ _ucExpander_State;
+	_ucExpander_State = ucPort;
+	return pEvent->ucChanged != 0;
+}
+
+unsigned char Expander_State (void)
+{
+	return _ucExpander_State;
+}
+
+// INT is low, leave it masked (it is a level) until it has been read
+ISR(INT0_vect)
+{
+	EIMSK &= ~(1 << INT0);
+	_ucExpander_Pending = 1;
+	if (_pExpander_Callback)
+		_pExpander_Callback();
+}
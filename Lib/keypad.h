@@ -0,0 +1,56 @@
+// Keypad library, ATmega328P Version
+// Revision History:
+// Oct 2026 - Initial Build, 4 x 4 matrix keypad on an input expander,
+//             scanned only after INT says something changed
+
+// rows on expander P0-P3, columns on P4-P7 (expander.h)
+// at rest every row is driven low and the columns are inputs, so a key
+//  pulls its column low and the expander raises INT. The INT0 ISR (re)starts
+//  a one-shot software timer (timer.h), bounces keep pushing it back, and
+//  once it runs out the callback releases the app's task, which calls
+//  Keypad_Poll to scan: a row low at a time, one write and one read each,
+//  then back to rest. So a key costs two scans (down and up) on the bus,
+//  and nothing goes out while the keypad is left alone
+// one key at a time, the first in scan order if more are down
+// needs Timer_Init (the service tick) and I2C_Init / I2C_SoftInit first
+
+#ifndef KEYPAD_SETTLE_TICKS
+#define KEYPAD_SETTLE_TICKS 2   // service ticks with no change before a scan (20ms)
+#endif
+
+#define KEYPAD_ROWS 4
+#define KEYPAD_COLS 4
+
+typedef enum Keypad_Type
+{
+	Keypad_Press,
+	Keypad_Release
+} Keypad_Type;
+
+typedef struct Keypad_Event
+{
+	Keypad_Type type;
+	char cKey;              // from the key map
+} Keypad_Event;
+
+struct I2C_Bus;
+
+// the keypad on the expander at uc7Addr, pKeys is KEYPAD_ROWS *
+//  KEYPAD_COLS characters (PROGMEM), row by row: "123A456B789C*0#D"
+// returns -1 if the expander didn't answer
+int Keypad_Init (struct I2C_Bus * pBus, unsigned char uc7Addr, const char * pKeys);
+
+// pCallback runs in the tick ISR when the keypad has settled after a
+//  change, Keypad_Poll has a scan to do (NULL for none)
+typedef void (*Keypad_Callback)(void);
+void Keypad_SetCallback (Keypad_Callback pCallback);
+
+// scan if the keypad has settled since the last call, queueing the press /
+//  release, returns -1 if the bus failed (tried again at the next settle)
+int Keypad_Poll (void);
+
+// take the oldest event, returns 0 if there is none
+int Keypad_Get (Keypad_Event * pEvent);
+
+// key down now (from the key map), 0 for none
+char Keypad_Key (void);
@@ -0,0 +1,143 @@
+// Keypad Library
+
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+#include "timer.h"
+#include "expander.h"
+#include "keypad.h"
+
+// rest: rows (low nibble) driven low, columns (high nibble) inputs
+#define KEYPAD_IDLE 0xF0
+#define KEYPAD_COL_MASK 0xF0
+
+// event queue (power of two entries), only filled and taken by Keypad_Poll
+//  and Keypad_Get, so no interrupt sees it
+#define KEYPAD_QUEUE 4
+static Keypad_Event _Keypad_Queue [KEYPAD_QUEUE];
+static unsigned char _ucKeypad_Head = 0;
+static unsigned char _ucKeypad_Tail = 0;
+
+static const char * _pKeypad_Keys = 0;
+static char _cKeypad_Down = 0;
+static volatile unsigned char _ucKeypad_Settled = 0;
+static Keypad_Callback _pKeypad_Callback = 0;
+
+// pushed back by every INT until the keypad is quiet
+static Timer_Soft _tKeypad;
+
+static void Keypad_Put (Keypad_Type type, char cKey)
+{
+	unsigned char ucNext = (_ucKeypad_Head + 1) & (KEYPAD_QUEUE - 1);
+
+	// full, the oldest goes
+	if (ucNext == _ucKeypad_Tail)
+		_ucKeypad_Tail = (_ucKeypad_Tail + 1) & (KEYPAD_QUEUE - 1);
+	_Keypad_Queue[_ucKeypad_Head].type = type;
+	_Keypad_Queue[_ucKeypad_Head].cKey = cKey;
+	_ucKeypad_Head = ucNext;
+}
+
+// tick ISR, quiet for KEYPAD_SETTLE_TICKS
+static void Keypad_Settled (void)
+{
+	_ucKeypad_Settled = 1;
+	if (_pKeypad_Callback)
+		_pKeypad_Callback();
+}
+
+// INT0 ISR, INT stays masked until the scan's last read
+static void Keypad_Changed (void)
+{
+	Timer_Start(&_tKeypad, KEYPAD_SETTLE_TICKS, 0, Keypad_Settled);
+}
+
+// a row low at a time, the first key found (0 for none), -1 on a bus error
+static int Keypad_Scan (void)
+{
+	for (unsigned char ucRow = 0; ucRow < KEYPAD_ROWS; ++ucRow)
+	{
+		unsigned char ucPort;
+
+		if (Expander_Write(KEYPAD_IDLE | (~(1 << ucRow) & ~KEYPAD_COL_MASK)))
+			return -1;
+		if (Expander_Read(&ucPort))
+			return -1;
+
+		ucPort = ~ucPort & KEYPAD_COL_MASK;
+		for (unsigned char ucCol = 0; ucCol < KEYPAD_COLS; ++ucCol)
+		{
+			if (ucPort & (0x10 << ucCol))
+				return (unsigned char)pgm_read_byte(&_pKeypad_Keys[ucRow * KEYPAD_COLS + ucCol]);
+		}
+	}
+	return 0;
+}
+
+int Keypad_Init (struct I2C_Bus * pBus, unsigned char uc7Addr, const char * pKeys)
+{
+	_pKeypad_Keys = pKeys;
+	_cKeypad_Down = 0;
+	_ucKeypad_Head = _ucKeypad_Tail = 0;
+	_ucKeypad_Settled = 0;
+
+	Expander_SetCallback(Keypad_Changed);
+	return Expander_Init(pBus, uc7Addr, KEYPAD_IDLE);
+}
+
+void Keypad_SetCallback (Keypad_Callback pCallback)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		_pKeypad_Callback = pCallback;
+	}
+}
+
+int Keypad_Poll (void)
+{
+	Expander_Event ev;
+	int iKey;
+
+	if (!_ucKeypad_Settled)
+		return 0;
+	_ucKeypad_Settled = 0;
+
+	Expander_Hold();
+	iKey = Keypad_Scan();
+
+	// back to rest, the poll's read lets INT go (the scan's own edges
+	//  with it) and unmasks INT0, a failure leaves it masked for the retry
+	if (iKey < 0 || Expander_Write(KEYPAD_IDLE) || Expander_Poll(&ev) < 0)
+	{
+		Keypad_Changed();
+		return -1;
+	}
+
+	if (iKey != _cKeypad_Down)
+	{
+		if (_cKeypad_Down)
+			Keypad_Put(Keypad_Release, _cKeypad_Down);
+		if (iKey)
+			Keypad_Put(Keypad_Press, (char)iKey);
+		_cKeypad_Down = (char)iKey;
+	}
+
+	// a change between the scan and the last read doesn't raise INT again
+	if (((ev.ucState & KEYPAD_COL_MASK) != KEYPAD_COL_MASK) != (iKey != 0))
+		Keypad_Changed();
+	return 0;
+}
+
+int Keypad_Get (Keypad_Event * pEvent)
+{
+	if (_ucKeypad_Head == _ucKeypad_Tail)
+		return 0;
+
+	*pEvent = _Keypad_Queue[_ucKeypad_Tail];
+	_ucKeypad_Tail = (_ucKeypad_Tail + 1) & (KEYPAD_QUEUE - 1);
+	return 1;
+}
+
+char Keypad_Key (void)
+{
+	return _cKeypad_Down;
+}
@@ -0,0 +1,42 @@
+// Memory library, ATmega328P Version
+// Revision History:
+// Oct 2026 - Initial Build, SRAM canary paint, stack high-water mark and
+//             a low stack alarm
+
+// 2KB of SRAM: .data and .bss from the bottom, the stack down from the
+//  top, and the gap in between. Nothing here uses malloc, so the gap starts
+//  at the end of .bss (__heap_start)
+// before main (and before the stack is used) the whole gap is painted
+//  with MEM_CANARY, so how far down the stack has ever been is the first
+//  byte above the heap start that isn't canary any more
+// MEM_ALARM_BYTES above the heap start is a guard: Mem_Alarm looks at a
+//  few bytes there (not the whole gap, so it can run every pass of the
+//  main loop), once the stack has reached them it trips and stays tripped
+// an ISR's frame counts as the stack too, so look after real load
+
+#ifndef MEM_CANARY
+#define MEM_CANARY 0xC5
+#endif
+#ifndef MEM_ALARM_BYTES
+#define MEM_ALARM_BYTES 64   // trip with this much gap left, or less
+#endif
+
+typedef struct Mem_Stat
+{
+	unsigned int uiStatic;    // .data + .bss
+	unsigned int uiGap;       // between the end of .bss and the stack now
+	unsigned int uiLeast;     // the least the gap has been (never touched)
+	unsigned int uiStackPeak; // most stack ever used
+} Mem_Stat;
+
+// gap now (stack pointer to the end of .bss)
+unsigned int Mem_Gap (void);
+
+// the least gap there has been, walks the canary up from the heap start
+unsigned int Mem_Least (void);
+
+// all of the above
+void Mem_Read (Mem_Stat * pStat);
+
+// the stack has come within MEM_ALARM_BYTES of the end of .bss
+int Mem_Alarm (void);
@@ -0,0 +1,72 @@
+// Memory Library
+
+#include <avr/io.h>
+#include "mem.h"
+
+// from the linker script
+extern unsigned char __data_start;
+extern unsigned char __heap_start;
+extern unsigned char __stack;
+
+// bytes looked at by Mem_Alarm, the stack might leave one of them canary
+#define MEM_GUARD 4
+
+static unsigned char _ucMem_Tripped = 0;
+
+// paint the gap before anything runs, .init1 comes before the stack
+//  pointer and r1 are set up (.init2), so this is done in registers only
+void Mem_Paint (void) __attribute__ ((naked, used, section (".init1")));
+void Mem_Paint (void)
+{
+	__asm volatile (
+		"	ldi r30, lo8(__heap_start)\n"
+		"	ldi r31, hi8(__heap_start)\n"
+		"	ldi r24, %0\n"
+		"	ldi r25, hi8(__stack)\n"
+		"	rjmp 2f\n"
+		"1:	st Z+, r24\n"
+		"2:	cpi r30, lo8(__stack)\n"
+		"	cpc r31, r25\n"
+		"	brlo 1b\n"
+		: : "M" (MEM_CANARY) : "r24", "r25", "r30", "r31");
+}
+
+unsigned int Mem_Gap (void)
+{
+	return SP - (unsigned int)&__heap_start;
+}
+
+unsigned int Mem_Least (void)
+{
+	const unsigned char * pucAt = &__heap_start;
+
+	while (pucAt < &__stack && *pucAt == MEM_CANARY)
+		++pucAt;
+	return pucAt - &__heap_start;
+}
+
+void Mem_Read (Mem_Stat * pStat)
+{
+	pStat->uiStatic = &__heap_start - &__data_start;
+	pStat->uiGap = Mem_Gap();
+	pStat->uiLeast = Mem_Least();
+	pStat->uiStackPeak = &__stack - &__heap_start + 1 - pStat->uiLeast;
+}
+
+int Mem_Alarm (void)
+{
+	const unsigned char * pucGuard = &__heap_start + MEM_ALARM_BYTES;
+
+	if (!_ucMem_Tripped)
+	{
+		for (unsigned char i = 0; i < MEM_GUARD; ++i)
+		{
+			if (pucGuard[i] != MEM_CANARY)
+				_ucMem_Tripped = 1;
+		}
+		// the gap now might be under the guard without having touched it
+		if (Mem_Gap() < MEM_ALARM_BYTES)
+			_ucMem_Tripped = 1;
+	}
+	return _ucMem_Tripped;
+}
@@ -0,0 +1,47 @@
+// Power management library, ATmega328P Version
+// Revision History:
+// Oct 2026 - Initial Build, PRR gating, tickless power-save on a timer 2
+//             32.768kHz crystal timebase
+// Oct 2026 - Pin change wake-up moved to the button library, any wake that
+//             isn't timer 2 is reported as Power_Wake_Pin
+// Oct 2026 - Both sleeps may be entered with interrupts off, they come back
+//             on with the sleep instruction
+
+// power-save stops the CPU and IO clocks, so Timer1 (the software timer
+//  service and Timer_Micros) stops too. Timer 2 keeps counting from the
+//  watch crystal at 32Hz, wakes us for the next software timer due (or
+//  every 8s on overflow, to keep the count) and the slept time is handed
+//  to Timer_Advance, so time carries on as if Timer1 had never stopped
+// the library owns TIMER2_COMPA_vect and TIMER2_OVF_vect, wake-up pins are
+//  up to their drivers (button.h)
+// call either with interrupts off after a last look for work (Sched_Pending),
+//  interrupts are enabled with sleep_cpu, so one that comes in between still
+//  wakes us, they are on again when either returns
+
+// Power_Save return, what woke us
+#define Power_Wake_Timer 0b00000001   // timer 2 compare / overflow
+#define Power_Wake_Pin 0b00000010     // pin change (any other interrupt)
+
+// gate every module off and disable the ADC and analog comparator
+// call first, each driver turns its own module back on in its init
+void Power_Init (void);
+
+// start (or stop) the timer 2 timebase, needs a 32.768kHz watch crystal on
+//  TOSC1/TOSC2 (the XTAL pins, so the CPU runs from the internal RC)
+// call after Timer_Init / Timer_SetCpuClock, blocks until the first count
+//  (the crystal can take a second to start after power up)
+// stop it to use timer 2 for something else (PWM), start it again after
+void Power_Timebase (int bEnable);
+
+// idle sleep, all clocks but the CPU's keep running, any interrupt wakes
+void Power_Idle (void);
+
+// tickless power-save until the next software timer is due or a pin
+//  change, falls back to Power_Idle without the timebase or when the
+//  next timer is too close (under two 32Hz counts)
+// returns the Power_Wake_ bits for what woke us
+unsigned char Power_Save (void);
+
+// benchmark: sleeps ended so far, and seconds of timebase counted
+unsigned long Power_Wakeups (void);
+unsigned long Power_Seconds (void);
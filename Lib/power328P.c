@@ -0,0 +1,242 @@
+// Power management Library
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <util/atomic.h>
+#include "timer.h"
+#include "power.h"
+
+// timer 2 count rate, 32768Hz crystal / 1024
+#define POWER_T2_HZ 32
+
+// timer 2 busy flags, a write isn't done until its flag clears
+#define POWER_T2_BUSY ((1 << TCN2UB) | (1 << OCR2AUB) | (1 << OCR2BUB) | (1 << TCR2AUB) | (1 << TCR2BUB))
+
+static unsigned char _ucPower_Timebase = 0;
+static volatile unsigned long _ulPower_T2Ovf = 0;
+static volatile unsigned char _ucPower_Woke = 0;
+static unsigned long _ulPower_Wakeups = 0;
+
+// anchor: Timer_Ticks value at the start of timer 2 count _ulPower_RefT2
+// only a wake on a timer 2 edge knows where in a count it is, those move
+//  the anchor, so time across sleeps is exact to the crystal and the error
+//  of a pin change wake is put right at the next timer wake
+static unsigned long _ulPower_RefT2 = 0;
+static unsigned long _ulPower_RefT1 = 0;
+
+// timer 2 counts to Timer1 counts (floor) and back (ceiling)
+// only done once or twice a sleep, so the 64-bit math is affordable
+static unsigned long Power_T2toT1 (unsigned long ulCounts)
+{
+	return (unsigned long)((unsigned long long)ulCounts * Timer_Hz() / POWER_T2_HZ);
+}
+
+static unsigned long Power_T1toT2 (unsigned long ulCounts)
+{
+	unsigned long ulHz = Timer_Hz();
+
+	return (unsigned long)(((unsigned long long)ulCounts * POWER_T2_HZ + ulHz - 1) / ulHz);
+}
+
+// extended timer 2 count, interrupts must be off
+// TCNT2 can read stale right after a wake, an OCR2B write that has gone
+//  through means a TOSC1 edge went by (18.9)
+static unsigned long Power_T2Count (void)
+{
+	unsigned long ulOvf;
+	unsigned char ucCount;
+
+	OCR2B = 0;
+	while (ASSR & (1 << OCR2BUB))
+		;
+	ucCount = TCNT2;
+	ulOvf = _ulPower_T2Ovf;
+	if ((TIFR2 & (1 << TOV2)) && ucCount < 0x80)
+		++ulOvf;
+	return (ulOvf << 8) | ucCount;
+}
+
+void Power_Init (void)
+{
+	// the ADC has to be off before it is gated, or it stays powered
+	ADCSRA = 0;
+	ACSR = 1 << ACD;
+
+	// TWI, timers 0 - 2, SPI, USART0, ADC
+	PRR = 0xFF;
+}
+
+void Power_Timebase (int bEnable)
+{
+	unsigned char ucCount;
+
+	TIMSK2 = 0;
+	_ucPower_Timebase = 0;
+	if (!bEnable)
+		return;
+
+	PRR &= ~(1 << PRTIM2);
+
+	// switch to the crystal first, it can corrupt the other registers
+	TCCR2B = 0;
+	ASSR |= 1 << AS2;
+	TCNT2 = 0;
+	OCR2A = 0;
+	OCR2B = 0;
+	TCCR2A = 0;             // normal mode, outputs off
+	TCCR2B = 0b00000111;    // divide by 1024
+	while (ASSR & POWER_T2_BUSY)
+		;
+	TIFR2 = (1 << OCF2B) | (1 << OCF2A) | (1 << TOV2);
+	TIMSK2 = 1 << TOIE2;
+
+	// anchor on a count edge
+	ucCount = TCNT2;
+	while (TCNT2 == ucCount)
+		;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		_ulPower_RefT2 = Power_T2Count();
+		_ulPower_RefT1 = Timer_Ticks();
+		_ucPower_Timebase = 1;
+	}
+}
+
+void Power_Idle (void)
+{
+	set_sleep_mode(SLEEP_MODE_IDLE);
+	sleep_enable();
+	sei();  // takes effect after the next instruction, so nothing gets in
+	sleep_cpu();
+	sleep_disable();
+	++_ulPower_Wakeups;
+}
+
+unsigned char Power_Save (void)
+{
+	unsigned long ulNow;
+	unsigned long ulDue;
+	unsigned long ulT2;
+	unsigned long ulTarget;
+	unsigned char ucWoke;
+
+	if (!_ucPower_Timebase)
+	{
+		Power_Idle();
+		return Power_Wake_Timer;
+	}
+
+	cli();
+	ulNow = Timer_Ticks();
+	ulDue = Timer_Pending();
+	ulT2 = Power_T2Count();
+
+	// an anchor from before a long stretch awake (Timer1 on the RC) is no
+	//  good, start a new one from the middle of this count
+	if (ulT2 - _ulPower_RefT2 > 0xFF)
+	{
+		_ulPower_RefT2 = ulT2;
+		_ulPower_RefT1 = ulNow - Power_T2toT1(1) / 2;
+	}
+
+	if (ulDue)
+	{
+		// first count edge at or after the timer is due
+		unsigned long ulEdge = _ulPower_RefT2 + Power_T1toT2(ulNow + ulDue - _ulPower_RefT1);
+
+		// a compare this close might already be gone by the time OCR2A is
+		//  written through, so tick along in idle instead
+		if (ulEdge - ulT2 < 2)
+		{
+			Power_Idle();
+			return Power_Wake_Timer;
+		}
+
+		// beyond one lap the overflow wakes us first, and we come back here
+		if (ulEdge - ulT2 <= 0xFF)
+		{
+			OCR2A = (unsigned char)ulEdge;
+			TIFR2 = 1 << OCF2A;
+			TIMSK2 |= 1 << OCIE2A;
+		}
+	}
+
+	// a write to timer 2 has to have gone through before we sleep, or we
+	//  could wake straight back up (or not at all) (18.9)
+	OCR2B = 0;
+	while (ASSR & POWER_T2_BUSY)
+		;
+
+	_ucPower_Woke = 0;
+	set_sleep_mode(SLEEP_MODE_PWR_SAVE);
+	sleep_enable();
+	sleep_bod_disable();
+	sei();
+	sleep_cpu();
+	sleep_disable();
+
+	// the wake-up ISR has run, work out how long we were gone
+	cli();
+	TIMSK2 &= ~(1 << OCIE2A);
+	ucWoke = _ucPower_Woke;
+	ulT2 = Power_T2Count();
+	ulTarget = _ulPower_RefT1 + Power_T2toT1(ulT2 - _ulPower_RefT2);
+	if (ucWoke & Power_Wake_Timer)
+	{
+		// on a count edge, exact, move the anchor up
+		_ulPower_RefT2 = ulT2;
+		_ulPower_RefT1 = ulTarget;
+	}
+	else
+	{
+		ulTarget += Power_T2toT1(1) / 2;  // somewhere in the count, take the middle
+		ucWoke |= Power_Wake_Pin;
+	}
+
+	// Timer1 stood still while we slept, never step time backwards
+	ulNow = Timer_Ticks();
+	if ((long)(ulTarget - ulNow) > 0)
+		Timer_Advance(ulTarget - ulNow);
+	++_ulPower_Wakeups;
+	sei();
+
+	return ucWoke;
+}
+
+unsigned long Power_Wakeups (void)
+{
+	unsigned long ulWakeups;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		ulWakeups = _ulPower_Wakeups;
+	}
+	return ulWakeups;
+}
+
+unsigned long Power_Seconds (void)
+{
+	unsigned long ulT2;
+
+	if (!_ucPower_Timebase)
+		return 0;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		ulT2 = Power_T2Count();
+	}
+	return ulT2 / POWER_T2_HZ;
+}
+
+// timer 2 overflow, every 8 seconds, count the upper bits
+ISR(TIMER2_OVF_vect)
+{
+	++_ulPower_T2Ovf;
+	_ucPower_Woke |= Power_Wake_Timer;
+}
+
+// timer 2 compare, the next software timer is due
+ISR(TIMER2_COMPA_vect)
+{
+	_ucPower_Woke |= Power_Wake_Timer;
+}
@@ -0,0 +1,79 @@
+// Profiling library, ATmega328P Version
+// Revision History:
+// Oct 2026 - Initial Build, probes on the free running Timer1 count
+
+// define _PROF for the whole project (compiler symbols) to build the probes
+//  in, prof328P.c has to see it too. Without it every PROF_ macro is empty
+//  and nothing is left in the image
+//
+//   PROF_BEGIN(PROF_LCD);
+//   LCD_StringXY(0, 0, buff);
+//   PROF_END(PROF_LCD);
+//
+// ids are small numbers (an enum in the app) below PROF_PROBES, BEGIN and
+//  END must be in the same block (BEGIN declares the start count there)
+// resolution is one Timer1 count (the Timer_Init prescaler, 64 CPU cycles
+//  at Timer_Prescale_64), a probe must span less than 65536 counts, and
+//  interrupts taken inside the span are counted in it
+// the start read is inside the span, about 4 cycles of probe overhead, the
+//  bookkeeping is done after the end read
+
+#ifndef PROF_PROBES
+#define PROF_PROBES 8
+#endif
+
+typedef struct Prof_Stat
+{
+	unsigned long ulCount;  // spans recorded
+	unsigned long ulSum;    // counts, all spans
+	unsigned int uiMin;     // counts, shortest span
+	unsigned int uiMax;     // counts, longest span
+} Prof_Stat;
+
+// receives one formatted line per probe with spans recorded, "id min/avg/max"
+//  in microseconds (16 characters or less below 10ms)
+typedef void (*Prof_Sink)(unsigned char ucId, const char * szLine);
+
+#ifdef _PROF
+
+#include <avr/io.h>
+#include <util/atomic.h>
+
+// Timer1 count, TCNT1 is read through the shared TEMP register, which an
+//  ISR touching another 16-bit Timer1 register would upset
+static inline unsigned int Prof_Now (void)
+{
+	unsigned int uiNow;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		uiNow = TCNT1;
+	}
+	return uiNow;
+}
+
+#define PROF_BEGIN(id) unsigned int _uiProf_##id = Prof_Now()
+#define PROF_END(id) Prof_Record((id), Prof_Now() - _uiProf_##id)
+#define PROF_DUMP(sink) Prof_Dump(sink)
+#define PROF_RESET() Prof_Reset()
+
+// add a span of uiCounts Timer1 counts to probe ucId
+void Prof_Record (unsigned char ucId, unsigned int uiCounts);
+
+// copy of a probe, returns 0 if it has no spans yet
+int Prof_Read (unsigned char ucId, Prof_Stat * pStat);
+
+// format every probe with spans and hand the lines to pSink
+void Prof_Dump (Prof_Sink pSink);
+
+// clear every probe
+void Prof_Reset (void);
+
+#else
+
+#define PROF_BEGIN(id)
+#define PROF_END(id)
+#define PROF_DUMP(sink)
+#define PROF_RESET()
+
+#endif
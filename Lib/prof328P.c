@@ -0,0 +1,74 @@
+// Profiling Library
+
+#include "prof.h"
+
+#ifdef _PROF
+
+#include <stdio.h>
+#include "timer.h"
+
+static Prof_Stat _Prof_Table [PROF_PROBES];
+
+void Prof_Record (unsigned char ucId, unsigned int uiCounts)
+{
+	Prof_Stat * pStat;
+
+	if (ucId >= PROF_PROBES)
+		return;
+	pStat = &_Prof_Table[ucId];
+
+	if (!pStat->ulCount || uiCounts < pStat->uiMin)
+		pStat->uiMin = uiCounts;
+	if (uiCounts > pStat->uiMax)
+		pStat->uiMax = uiCounts;
+	pStat->ulSum += uiCounts;
+	++pStat->ulCount;
+}
+
+int Prof_Read (unsigned char ucId, Prof_Stat * pStat)
+{
+	if (ucId >= PROF_PROBES)
+		return 0;
+
+	// a probe in an ISR could be mid update
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		*pStat = _Prof_Table[ucId];
+	}
+	return pStat->ulCount != 0;
+}
+
+// Timer1 counts to microseconds
+static unsigned long Prof_Micros (unsigned long ulCounts, unsigned long ulHz)
+{
+	return (unsigned long)((unsigned long long)ulCounts * 1000000 / ulHz);
+}
+
+void Prof_Dump (Prof_Sink pSink)
+{
+	unsigned long ulHz = Timer_Hz();
+	Prof_Stat stat;
+	char szLine [32];
+
+	if (!ulHz)
+		return;
+
+	for (unsigned char i = 0; i < PROF_PROBES; ++i)
+	{
+		if (!Prof_Read(i, &stat))
+			continue;
+		(void)sprintf(szLine, "%u %lu/%lu/%lu", i, Prof_Micros(stat.uiMin, ulHz), (unsigned long)((unsigned long long)stat.ulSum * 1000000 / ((unsigned long long)ulHz * stat.ulCount)), Prof_Micros(stat.uiMax, ulHz));
+		pSink(i, szLine);
+	}
+}
+
+void Prof_Reset (void)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		for (unsigned char i = 0; i < PROF_PROBES; ++i)
+			_Prof_Table[i] = (Prof_Stat){ 0, 0, 0, 0 };
+	}
+}
+
+#endif
@@ -0,0 +1,69 @@
+// PWM library, ATmega328P Version
+// 8-bit timers 0 and 2, both output compare channels
+// Revision History:
+// Oct 2026 - Initial Build
+
+// pins: OC0A PD6, OC0B PD5, OC2A PB3, OC2B PD3
+// no interrupts are used, the waveform is all hardware once enabled
+
+typedef enum PWM_Timer
+{
+	PWM_Timer0,
+	PWM_Timer2
+} PWM_Timer;
+
+typedef enum PWM_Channel
+{
+	PWM_Channel_A,
+	PWM_Channel_B
+} PWM_Channel;
+
+typedef enum PWM_Mode
+{
+	PWM_Mode_Fast,          // single slope, up to twice the rate of phase correct
+	PWM_Mode_PhaseCorrect,  // dual slope, pulses centred, true 0% and 100%
+	PWM_Mode_Square         // CTC, outputs toggle once per period (50%, half rate)
+} PWM_Mode;
+
+// where the count turns around
+// PWM_Top_Max gives full 8-bit duty resolution on both channels, but the
+//  frequency is only as fine as the prescaler steps
+// PWM_Top_OCRA sets TOP from the requested frequency, OCRxA is then the
+//  period so only channel B can output PWM (square mode always works this way)
+typedef enum PWM_Top
+{
+	PWM_Top_Max,
+	PWM_Top_OCRA
+} PWM_Top;
+
+typedef enum PWM_Pol
+{
+	PWM_Pol_NonInverting,   // active high
+	PWM_Pol_Inverting       // active low
+} PWM_Pol;
+
+// clock timer 2 from a 32.768kHz watch crystal on TOSC1/TOSC2 (PB6/PB7)
+// these are the XTAL pins, so the CPU must run from the internal RC
+// call before PWM_Init for timer 2, pass the crystal rate as ulClockHz
+void PWM_Timer2Async (int bEnable);
+
+// set up a timer for PWM closest to ulHz, from a clock of ulClockHz
+//  (F_CPU, or the crystal rate in async mode), outputs start disabled
+// returns the frequency achieved in Hz, or 0 if ulHz is out of reach
+unsigned long PWM_Init (PWM_Timer timer, PWM_Mode mode, PWM_Top top, unsigned long ulClockHz, unsigned long ulHz);
+
+// connect a channel to its pin (pin is made an output, inactive level
+//  while disconnected) / release it again, leaving the pin inactive
+void PWM_Enable (PWM_Timer timer, PWM_Channel chan, PWM_Pol pol);
+void PWM_Disable (PWM_Timer timer, PWM_Channel chan);
+
+// duty 0 - 255 (255 is 100%) of the time at the active level, scaled to TOP
+// OCRx is double buffered by the hardware in the PWM modes and only taken
+//  at TOP / BOTTOM, so a change never cuts a period short
+// fast PWM can't reach 0% (OCRx = 0 is still a one count spike), so duty 0
+//  parks the pin at its inactive level until a non-zero duty comes back
+// ignored in square mode
+void PWM_SetDuty (PWM_Timer timer, PWM_Channel chan, unsigned char ucDuty);
+
+// restart the count from BOTTOM, to line a square wave up with an event
+void PWM_Restart (PWM_Timer timer);
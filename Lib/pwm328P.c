@@ -0,0 +1,274 @@
+// PWM Library
+// 8-bit timers 0 and 2
+
+#include <avr/io.h>
+#include "pwm.h"
+
+// timer 0 and timer 2 have the same register layout, five in a row
+//  TCCRxA, TCCRxB, TCNTx, OCRxA, OCRxB, so one base pointer reaches them all
+#define PWM_TCCRA 0
+#define PWM_TCCRB 1
+#define PWM_TCNT 2
+#define PWM_OCRA 3
+#define PWM_OCRB 4
+
+// TCCRxB
+#define PWM_WGM2 0b00001000
+#define PWM_FOCA 0b10000000
+#define PWM_FOCB 0b01000000
+
+// prescale dividers by clock select value (1 based)
+static const unsigned int _uiPWM_Div0 [] = { 1, 8, 64, 256, 1024 };
+static const unsigned int _uiPWM_Div2 [] = { 1, 8, 32, 64, 128, 256, 1024 };
+
+// per timer state
+static unsigned char _ucPWM_Top [2] = { 0xFF, 0xFF };
+static PWM_Mode _PWM_Mode [2] = { PWM_Mode_Fast, PWM_Mode_Fast };
+static unsigned char _ucPWM_Com [2] = { 0, 0 };       // COM bits of enabled channels
+static unsigned char _ucPWM_Duty [2][2] = { { 0, 0 }, { 0, 0 } };
+
+static volatile unsigned char * PWM_Regs (PWM_Timer timer)
+{
+	return timer == PWM_Timer0 ? &TCCR0A : &TCCR2A;
+}
+
+// in async mode timer 2 registers are written through to the crystal clock
+//  domain, a second write before the first lands would be lost
+static void PWM_Sync (PWM_Timer timer)
+{
+	if (timer == PWM_Timer2 && (ASSR & (1 << AS2)))
+		while (ASSR & ((1 << TCN2UB) | (1 << OCR2AUB) | (1 << OCR2BUB) | (1 << TCR2AUB) | (1 << TCR2BUB)))
+			;
+}
+
+// COM bits of a channel in TCCRxA
+static unsigned char PWM_ComMask (PWM_Channel chan)
+{
+	return chan == PWM_Channel_A ? 0b11000000 : 0b00110000;
+}
+
+// make the channel pin an output, at the inactive level for the polarity
+static void PWM_Pin (PWM_Timer timer, PWM_Channel chan, PWM_Pol pol)
+{
+	volatile unsigned char * pDDR = &DDRD;
+	volatile unsigned char * pPORT = &PORTD;
+	unsigned char ucBit;
+
+	if (timer == PWM_Timer0)
+		ucBit = chan == PWM_Channel_A ? PD6 : PD5;
+	else if (chan == PWM_Channel_A)
+	{
+		pDDR = &DDRB;
+		pPORT = &PORTB;
+		ucBit = PB3;
+	}
+	else
+		ucBit = PD3;
+
+	if (pol == PWM_Pol_NonInverting)
+		*pPORT &= ~(1 << ucBit);
+	else
+		*pPORT |= 1 << ucBit;
+	*pDDR |= 1 << ucBit;
+}
+
+void PWM_Timer2Async (int bEnable)
+{
+	PRR &= ~(1 << PRTIM2);
+
+	// switching the clock source can corrupt the timer registers, so stop
+	//  first and let PWM_Init set them all up again
+	TCCR2B = 0;
+	if (bEnable)
+		ASSR |= 1 << AS2;
+	else
+		ASSR &= ~(1 << AS2);
+	PWM_Sync(PWM_Timer2);
+}
+
+unsigned long PWM_Init (PWM_Timer timer, PWM_Mode mode, PWM_Top top, unsigned long ulClockHz, unsigned long ulHz)
+{
+	volatile unsigned char * pRegs = PWM_Regs(timer);
+	const unsigned int * pDiv = timer == PWM_Timer0 ? _uiPWM_Div0 : _uiPWM_Div2;
+	unsigned char ucDivs = timer == PWM_Timer0 ? sizeof(_uiPWM_Div0) / sizeof(_uiPWM_Div0[0]) : sizeof(_uiPWM_Div2) / sizeof(_uiPWM_Div2[0]);
+	unsigned char ucCS = 0;
+	unsigned char ucTop = 0xFF;
+	unsigned long ulBest = 0;
+
+	// the power reduction bit stops the clock to the timer
+	PRR &= ~(1 << (timer == PWM_Timer0 ? PRTIM0 : PRTIM2));
+
+	// square wave is CTC, period in OCRxA
+	if (mode == PWM_Mode_Square)
+		top = PWM_Top_OCRA;
+
+	if (!ulHz)
+		return 0;
+
+	for (unsigned char i = 0; i < ucDivs; ++i)
+	{
+		unsigned long ulCountHz = ulClockHz / pDiv[i];
+		unsigned long ulGot;
+		unsigned long ulCounts;
+		unsigned int uiTop;
+
+		if (ulHz > ulCountHz)
+			continue;
+
+		if (top == PWM_Top_Max)
+		{
+			// fixed period, 256 counts single slope or 510 dual slope
+			ulGot = ulCountHz / (mode == PWM_Mode_Fast ? 256 : 510);
+			if (!ucCS || (ulGot > ulHz ? ulGot - ulHz : ulHz - ulGot) < (ulBest > ulHz ? ulBest - ulHz : ulHz - ulBest))
+			{
+				ucCS = i + 1;
+				ulBest = ulGot;
+			}
+			continue;
+		}
+
+		// counts per period, fast is TOP + 1, phase correct 2 * TOP,
+		//  square 2 * (TOP + 1) (a toggle each compare match)
+		ulCounts = (ulCountHz + ulHz / 2) / ulHz;
+		if (mode == PWM_Mode_Fast)
+			uiTop = ulCounts > 0x100 ? 0x100 : ulCounts - 1;
+		else if (mode == PWM_Mode_PhaseCorrect)
+			uiTop = ulCounts > 0x200 ? 0x100 : (ulCounts + 1) / 2;
+		else
+			uiTop = ulCounts > 0x200 ? 0x100 : (ulCounts + 1) / 2 - 1;
+
+		// smallest divider that fits gives the finest duty steps
+		if (uiTop >= 1 && uiTop <= 0xFF)
+		{
+			ucCS = i + 1;
+			ucTop = uiTop;
+			if (mode == PWM_Mode_Fast)
+				ulBest = ulCountHz / (ucTop + 1);
+			else if (mode == PWM_Mode_PhaseCorrect)
+				ulBest = ulCountHz / (2 * ucTop);
+			else
+				ulBest = ulCountHz / (2 * (ucTop + 1));
+			break;
+		}
+	}
+
+	if (!ucCS)
+		return 0;
+
+	// stop and disconnect while the mode changes
+	pRegs[PWM_TCCRB] = 0;
+	PWM_Sync(timer);
+	pRegs[PWM_TCCRA] = 0;
+	PWM_Sync(timer);
+
+	_ucPWM_Top[timer] = ucTop;
+	_PWM_Mode[timer] = mode;
+	_ucPWM_Com[timer] = 0;
+	_ucPWM_Duty[timer][PWM_Channel_A] = 0;
+	_ucPWM_Duty[timer][PWM_Channel_B] = 0;
+
+	pRegs[PWM_TCNT] = 0;
+	PWM_Sync(timer);
+	pRegs[PWM_OCRA] = top == PWM_Top_OCRA ? ucTop : 0;
+	PWM_Sync(timer);
+	pRegs[PWM_OCRB] = 0;
+	PWM_Sync(timer);
+
+	// waveform generation mode (14.9.1 / 17.11.1)
+	//  fast 3 (TOP 0xFF) or 7 (TOP OCRA), phase correct 1 or 5, CTC 2
+	if (mode == PWM_Mode_Fast)
+		pRegs[PWM_TCCRA] = 0b00000011;
+	else if (mode == PWM_Mode_PhaseCorrect)
+		pRegs[PWM_TCCRA] = 0b00000001;
+	else
+		pRegs[PWM_TCCRA] = 0b00000010;
+	PWM_Sync(timer);
+	pRegs[PWM_TCCRB] = (mode != PWM_Mode_Square && top == PWM_Top_OCRA ? PWM_WGM2 : 0) | ucCS;
+	PWM_Sync(timer);
+
+	return ulBest;
+}
+
+void PWM_Enable (PWM_Timer timer, PWM_Channel chan, PWM_Pol pol)
+{
+	volatile unsigned char * pRegs = PWM_Regs(timer);
+	unsigned char ucMask = PWM_ComMask(chan);
+	unsigned char ucCom;
+
+	// with TOP in OCRxA channel A has no compare of its own
+	if (chan == PWM_Channel_A && _PWM_Mode[timer] != PWM_Mode_Square && (pRegs[PWM_TCCRB] & PWM_WGM2))
+		return;
+
+	PWM_Pin(timer, chan, pol);
+
+	if (_PWM_Mode[timer] == PWM_Mode_Square)
+	{
+		// force the output to the active level (set for non-inverting, clear
+		//  for inverting), so the wave starts with an active half period
+		pRegs[PWM_TCCRA] = (pRegs[PWM_TCCRA] & ~ucMask) | ((pol == PWM_Pol_NonInverting ? 0b11111111 : 0b10101010) & ucMask);
+		PWM_Sync(timer);
+		pRegs[PWM_TCCRB] |= chan == PWM_Channel_A ? PWM_FOCA : PWM_FOCB;
+		PWM_Sync(timer);
+		ucCom = 0b01010101 & ucMask;  // toggle on compare match
+	}
+	else if (pol == PWM_Pol_NonInverting)
+		ucCom = 0b10101010 & ucMask;  // clear on compare match (up counting)
+	else
+		ucCom = 0b11111111 & ucMask;  // set on compare match (up counting)
+
+	_ucPWM_Com[timer] = (_ucPWM_Com[timer] & ~ucMask) | ucCom;
+
+	// fast PWM at duty 0 stays parked at the inactive level
+	if (_PWM_Mode[timer] == PWM_Mode_Fast && !_ucPWM_Duty[timer][chan])
+		ucCom = 0;
+	pRegs[PWM_TCCRA] = (pRegs[PWM_TCCRA] & ~ucMask) | ucCom;
+	PWM_Sync(timer);
+}
+
+void PWM_Disable (PWM_Timer timer, PWM_Channel chan)
+{
+	volatile unsigned char * pRegs = PWM_Regs(timer);
+	unsigned char ucMask = PWM_ComMask(chan);
+
+	// port takes over the pin, PWM_Pin left it at the inactive level
+	_ucPWM_Com[timer] &= ~ucMask;
+	pRegs[PWM_TCCRA] &= ~ucMask;
+	PWM_Sync(timer);
+}
+
+void PWM_SetDuty (PWM_Timer timer, PWM_Channel chan, unsigned char ucDuty)
+{
+	volatile unsigned char * pRegs = PWM_Regs(timer);
+	unsigned char ucMask = PWM_ComMask(chan);
+
+	if (_PWM_Mode[timer] == PWM_Mode_Square)
+		return;
+
+	_ucPWM_Duty[timer][chan] = ucDuty;
+
+	// buffered, the hardware takes it at the end of the period
+	pRegs[chan == PWM_Channel_A ? PWM_OCRA : PWM_OCRB] = ((unsigned int)ucDuty * _ucPWM_Top[timer] + 127) / 255;
+	PWM_Sync(timer);
+
+	// COM bits act at once, parking only ever shortens the pulse in flight
+	//  to nothing, and unparking only connects a pulse no longer than the new
+	//  duty
+	if (_PWM_Mode[timer] == PWM_Mode_Fast)
+	{
+		pRegs[PWM_TCCRA] = (pRegs[PWM_TCCRA] & ~ucMask) | (ucDuty ? _ucPWM_Com[timer] & ucMask : 0);
+		PWM_Sync(timer);
+	}
+}
+
+void PWM_Restart (PWM_Timer timer)
+{
+	// a write to TCNTx blocks a compare match on the next timer clock, so
+	//  the first match is a full period away
+	PWM_Regs(timer)[PWM_TCNT] = 0;
+	PWM_Sync(timer);
+
+	// timer 2 has its own prescaler, timer 0 shares one with timer 1 so that
+	//  one is left alone
+	if (timer == PWM_Timer2)
+		GTCCR |= 1 << PSRASY;
+}
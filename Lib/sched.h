@@ -0,0 +1,75 @@
+// Scheduler library, ATmega328P Version
+// Revision History:
+// Oct 2026 - Initial Build, cooperative run to completion tasks from a
+//             static table, periodic and event released, deadline and
+//             execution time counters
+// Oct 2026 - Sched_Pending, to look again with interrupts off before sleeping
+
+// the app lists its tasks in a table in flash, the order is the priority
+//  (first is highest). A task is released by its period (service ticks,
+//  timer.h) and / or by any of its event bits posted with Sched_Post, which
+//  is safe from an ISR (callbacks of timer.h, button.h, uart.h)
+//
+//   while (1)
+//   {
+//     if (Sched_Dispatch())
+//       continue;
+//     cli();            // a post from here on would be slept through
+//     if (Sched_Pending())
+//       sei();
+//     else
+//       Power_Idle();   // nothing ready, the next release is armed
+//   }
+//
+// Sched_Dispatch runs the highest priority ready task to the end and comes
+//  back, so a higher task released meanwhile goes next. A task that is
+//  released again before it has run misses, as does one that finishes
+//  later than its deadline after its release (the period if 0, event only
+//  tasks without a deadline never miss). Releases that fall while a task is
+//  still waiting are counted as misses and dropped, the period keeps its
+//  phase, so an overload shows up in the counters and never drifts
+// a task's time (Timer_Micros) includes the interrupts taken while it runs
+
+#ifndef SCHED_TASKS
+#define SCHED_TASKS 8   // most tasks in a table
+#endif
+
+typedef void (*Sched_Function)(void);
+
+typedef struct Sched_Task
+{
+	Sched_Function pRun;        // run to completion
+	unsigned int uiPeriod;      // service ticks between releases, 0 for events only
+	unsigned int uiDeadline;    // service ticks from release to done, 0 for the period
+	unsigned char ucEvents;     // Sched_Post bits that release it
+} Sched_Task;
+
+typedef struct Sched_Stat
+{
+	unsigned long ulRuns;       // times run
+	unsigned long ulWorstUs;    // longest run
+	unsigned int uiMisses;      // deadlines missed (saturates)
+} Sched_Stat;
+
+// take the task table (PROGMEM, ucCount entries), every task starts disabled
+// needs Timer_Init (the service tick) first
+void Sched_Init (const Sched_Task * pTable, unsigned char ucCount);
+
+// enable a task, a periodic one is released a period from now / disable it,
+//  dropping a release it hasn't run yet
+void Sched_Enable (unsigned char ucTask, int bEnable);
+
+// release the tasks waiting on any of the bits in ucEvents, from anywhere
+void Sched_Post (unsigned char ucEvents);
+
+// run the highest priority ready task, returns 0 if there was none (the
+//  service timer is armed for the next periodic release, sleep until then)
+int Sched_Dispatch (void);
+
+// is anything released and not run yet (posted, or a period that came due
+//  since Sched_Dispatch), safe with interrupts off, call it that way right
+//  before sleeping, a post after Sched_Dispatch looked would be stranded
+int Sched_Pending (void);
+
+// copy of a task's counters, returns 0 for a task that isn't in the table
+int Sched_Read (unsigned char ucTask, Sched_Stat * pStat);
@@ -0,0 +1,207 @@
+// Scheduler Library
+
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+#include "timer.h"
+#include "sched.h"
+
+static const Sched_Task * _pSched_Table = 0;
+static unsigned char _ucSched_Count = 0;
+
+static struct
+{
+	unsigned long ulNext;       // tick count of the next periodic release
+	unsigned int uiRelease;     // tick count (low bits) of the release waiting
+	unsigned char ucReady;      // released, not run yet
+	unsigned char ucEnabled;
+} _Sched_State [SCHED_TASKS];
+
+static Sched_Stat _Sched_Stat [SCHED_TASKS];
+
+// posted bits not collected yet, and the tick each bit was first posted at
+static volatile unsigned char _ucSched_Events = 0;
+static volatile unsigned int _auiSched_Posted [8];
+
+// wakes us for the next periodic release (no callback, the wake is enough)
+static Timer_Soft _tSched;
+
+static void Sched_Miss (unsigned char ucTask, unsigned long ulCount)
+{
+	unsigned long ulMisses = _Sched_Stat[ucTask].uiMisses + ulCount;
+
+	_Sched_Stat[ucTask].uiMisses = ulMisses > 0xFFFF ? 0xFFFF : (unsigned int)ulMisses;
+}
+
+// tick the oldest of the posted bits in ucEvents was posted at
+static unsigned int Sched_Posted (unsigned char ucEvents)
+{
+	unsigned int uiNow = (unsigned int)Timer_TickCount();
+	unsigned int uiOldest = 0;
+
+	for (unsigned char i = 0; i < 8; ++i)
+	{
+		if ((ucEvents & (1 << i)) && uiNow - _auiSched_Posted[i] >= uiOldest)
+			uiOldest = uiNow - _auiSched_Posted[i];
+	}
+	return uiNow - uiOldest;
+}
+
+void Sched_Init (const Sched_Task * pTable, unsigned char ucCount)
+{
+	if (ucCount > SCHED_TASKS)
+		ucCount = SCHED_TASKS;
+
+	_pSched_Table = pTable;
+	_ucSched_Count = ucCount;
+	for (unsigned char i = 0; i < SCHED_TASKS; ++i)
+	{
+		_Sched_State[i].ucReady = 0;
+		_Sched_State[i].ucEnabled = 0;
+		_Sched_Stat[i] = (Sched_Stat){ 0, 0, 0 };
+	}
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		_ucSched_Events = 0;
+	}
+}
+
+void Sched_Enable (unsigned char ucTask, int bEnable)
+{
+	Sched_Task task;
+
+	if (ucTask >= _ucSched_Count)
+		return;
+
+	memcpy_P(&task, &_pSched_Table[ucTask], sizeof task);
+	_Sched_State[ucTask].ucReady = 0;
+	_Sched_State[ucTask].ucEnabled = bEnable != 0;
+	if (bEnable)
+		_Sched_State[ucTask].ulNext = Timer_TickCount() + task.uiPeriod;
+}
+
+void Sched_Post (unsigned char ucEvents)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		unsigned int uiNow = (unsigned int)Timer_TickCount();
+
+		// a bit already waiting keeps its first stamp
+		for (unsigned char i = 0; i < 8; ++i)
+		{
+			if ((ucEvents & ~_ucSched_Events) & (1 << i))
+				_auiSched_Posted[i] = uiNow;
+		}
+		_ucSched_Events |= ucEvents;
+	}
+}
+
+int Sched_Pending (void)
+{
+	unsigned long ulNow = Timer_TickCount();
+	Sched_Task task;
+
+	if (_ucSched_Events)
+		return 1;
+	for (unsigned char i = 0; i < _ucSched_Count; ++i)
+	{
+		if (!_Sched_State[i].ucEnabled)
+			continue;
+		if (_Sched_State[i].ucReady)
+			return 1;
+		memcpy_P(&task, &_pSched_Table[i], sizeof task);
+		if (task.uiPeriod && (long)(ulNow - _Sched_State[i].ulNext) >= 0)
+			return 1;
+	}
+	return 0;
+}
+
+int Sched_Dispatch (void)
+{
+	unsigned long ulNow = Timer_TickCount();
+	unsigned long ulWake = 0;
+	unsigned char ucEvents;
+	unsigned char ucRun = 0xFF;
+	Sched_Task task;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		ucEvents = _ucSched_Events;
+		_ucSched_Events = 0;
+	}
+
+	// release everything due, then pick the first (highest) ready
+	for (unsigned char i = 0; i < _ucSched_Count; ++i)
+	{
+		if (!_Sched_State[i].ucEnabled)
+			continue;
+		memcpy_P(&task, &_pSched_Table[i], sizeof task);
+
+		// events coalesce, the deadline runs from the first one
+		if ((task.ucEvents & ucEvents) && !_Sched_State[i].ucReady)
+		{
+			_Sched_State[i].uiRelease = Sched_Posted(task.ucEvents & ucEvents);
+			_Sched_State[i].ucReady = 1;
+		}
+
+		if (task.uiPeriod)
+		{
+			if ((long)(ulNow - _Sched_State[i].ulNext) >= 0)
+			{
+				// releases that went by unseen are missed, and so is one
+				//  still waiting to run, keep the phase of the period
+				unsigned long ulLate = (ulNow - _Sched_State[i].ulNext) / task.uiPeriod;
+
+				_Sched_State[i].ulNext += (ulLate + 1) * task.uiPeriod;
+				Sched_Miss(i, ulLate + (_Sched_State[i].ucReady ? 1 : 0));
+				_Sched_State[i].uiRelease = (unsigned int)(_Sched_State[i].ulNext - task.uiPeriod);
+				_Sched_State[i].ucReady = 1;
+			}
+			if (!ulWake || (long)(_Sched_State[i].ulNext - ulWake) < 0)
+				ulWake = _Sched_State[i].ulNext;
+		}
+
+		if (_Sched_State[i].ucReady && ucRun == 0xFF)
+			ucRun = i;
+	}
+
+	if (ucRun == 0xFF)
+	{
+		// nothing to do, make sure we wake for the next release
+		if (ulWake)
+		{
+			unsigned long ulTicks = ulWake - ulNow;
+
+			Timer_Start(&_tSched, ulTicks > 0xFFFF ? 0xFFFF : (unsigned int)ulTicks, 0, 0);
+		}
+		else
+			(void)Timer_Stop(&_tSched);
+		return 0;
+	}
+
+	memcpy_P(&task, &_pSched_Table[ucRun], sizeof task);
+	_Sched_State[ucRun].ucReady = 0;
+	{
+		unsigned long ulStart = Timer_Micros();
+		unsigned int uiDeadline = task.uiDeadline ? task.uiDeadline : task.uiPeriod;
+		Sched_Stat * pStat = &_Sched_Stat[ucRun];
+
+		task.pRun();
+
+		ulStart = Timer_Micros() - ulStart;
+		++pStat->ulRuns;
+		if (ulStart > pStat->ulWorstUs)
+			pStat->ulWorstUs = ulStart;
+		if (uiDeadline && (unsigned int)Timer_TickCount() - _Sched_State[ucRun].uiRelease > uiDeadline)
+			Sched_Miss(ucRun, 1);
+	}
+	return 1;
+}
+
+int Sched_Read (unsigned char ucTask, Sched_Stat * pStat)
+{
+	if (ucTask >= _ucSched_Count)
+		return 0;
+
+	*pStat = _Sched_Stat[ucTask];
+	return 1;
+}
@@ -0,0 +1,68 @@
+// Telemetry library, ATmega328P Version
+// Revision History:
+// Oct 2026 - Initial Build, framed binary diagnostics on the UART
+// Oct 2026 - Display frame counters (TELEM_FRAMES)
+// Oct 2026 - Scheduler task counters (TELEM_TASK)
+// Oct 2026 - SRAM use (TELEM_MEM)
+// Oct 2026 - I2C lane throughput (TELEM_BUS)
+// Oct 2026 - TELEM_MEM built by the app (Telem_Frame), no mem.h here
+// Oct 2026 - TELEM_TASK built by the app too, no sched.h here
+
+// frames go out through the UART library's transmit ring, a frame that
+//  doesn't fit is dropped (never waits), so diagnostics can stay on in
+//  production without holding up the main loop or touching the I2C bus
+// UART_Init has to be called first
+//
+// frame: type, sequence, payload, CRC-8 (CCITT, seed 0, over type to the
+//  end of the payload), byte stuffed like HDLC and ended by a flag:
+//   0x7E ends a frame, 0x7D escapes the next byte (sent XOR 0x20)
+// the sequence counts every frame, sent or dropped, so the host can see
+//  what it missed. All fields are little endian
+//
+// Tools/telemdump.c decodes the stream on a Linux host, it shares the
+//  definitions below
+
+#define TELEM_FLAG 0x7E
+#define TELEM_ESC 0x7D
+#define TELEM_XOR 0x20
+
+#define TELEM_VERSION 1
+#define TELEM_PAYLOAD 16  // most payload bytes in a frame
+
+// frame types, payload
+#define TELEM_HELLO 0x01  // u8 version, u32 timer Hz (Timer1 counts a second)
+#define TELEM_TIME 0x02   // u32 us, u32 centiseconds, u8 tag (0 running, else lap)
+#define TELEM_STATE 0x03  // u32 us, u8 state, u8 event, u8 next state
+#define TELEM_PROF 0x04   // u8 id, u32 spans, u32 sum, u16 min, u16 max (Timer1 counts)
+#define TELEM_I2C 0x05    // u32 starts, u32 bytes, u16 errors, u8 UART bytes lost
+#define TELEM_FRAMES 0x06 // u32 frames, u16 overruns, u16 deferred, u32 worst frame us
+#define TELEM_TASK 0x07   // u8 task, u32 runs, u32 worst us, u16 deadline misses (app, sched.h)
+#define TELEM_MEM 0x08    // u16 static, u16 gap, u16 least gap, u16 stack peak, u8 alarm (app, mem.h)
+#define TELEM_BUS 0x09    // u8 lane, u32 bytes, u32 us (an I2C throughput run)
+
+// host requests, single bytes received
+#define TELEM_REQ_HELLO 'h'
+#define TELEM_REQ_COUNTERS 'c'
+
+// send a flag (so the first frame starts clean) and a hello
+void Telem_Init (void);
+
+// queue one frame, returns 0 if it was dropped (no room)
+int Telem_Frame (unsigned char ucType, const unsigned char * pucPayload, unsigned char ucCount);
+
+// typed frames, each returns 0 if it was dropped
+int Telem_Hello (void);
+int Telem_Time (unsigned long ulUs, unsigned long ulCs, unsigned char ucTag);
+int Telem_State (unsigned long ulUs, unsigned char ucState, unsigned char ucEvent, unsigned char ucNext);
+int Telem_I2C (void);
+int Telem_Frames (unsigned long ulFrames, unsigned int uiOverruns, unsigned int uiDeferred, unsigned long ulWorstUs);
+int Telem_Bus (unsigned char ucLane, unsigned long ulBytes, unsigned long ulUs);
+
+// one frame for each profiling probe with spans (nothing without _PROF)
+void Telem_Prof (void);
+
+// answer the requests received, call from the main loop
+// returns 1 if the host asked for the counters, for the app to add its own
+//  (the frames of modules the library doesn't depend on, TELEM_MEM and
+//  TELEM_TASK)
+int Telem_Poll (void);
@@ -0,0 +1,182 @@
+// Telemetry Library
+
+#include <util/crc16.h>
+#include "uart.h"
+#include "timer.h"
+#include "I2C.h"
+#include "prof.h"
+#include "telem.h"
+
+// type, sequence, payload, CRC, every byte escaped, and the flag
+#define TELEM_FRAME (2 * (TELEM_PAYLOAD + 3) + 1)
+
+static unsigned char _ucTelem_Seq = 0;
+
+static unsigned char * Telem_U16 (unsigned char * pucAt, unsigned int uiValue)
+{
+	*pucAt++ = uiValue;
+	*pucAt++ = uiValue >> 8;
+	return pucAt;
+}
+
+static unsigned char * Telem_U32 (unsigned char * pucAt, unsigned long ulValue)
+{
+	pucAt = Telem_U16(pucAt, ulValue);
+	return Telem_U16(pucAt, ulValue >> 16);
+}
+
+// stuff one byte into the frame
+static unsigned char * Telem_Stuff (unsigned char * pucAt, unsigned char ucByte)
+{
+	if (ucByte == TELEM_FLAG || ucByte == TELEM_ESC)
+	{
+		*pucAt++ = TELEM_ESC;
+		ucByte ^= TELEM_XOR;
+	}
+	*pucAt++ = ucByte;
+	return pucAt;
+}
+
+void Telem_Init (void)
+{
+	unsigned char ucFlag = TELEM_FLAG;
+
+	(void)UART_Write(&ucFlag, 1);
+	(void)Telem_Hello();
+}
+
+int Telem_Frame (unsigned char ucType, const unsigned char * pucPayload, unsigned char ucCount)
+{
+	unsigned char aucFrame [TELEM_FRAME];
+	unsigned char * pucAt = aucFrame;
+	unsigned char ucSeq = _ucTelem_Seq++;
+	unsigned char ucCrc;
+
+	if (ucCount > TELEM_PAYLOAD)
+		return 0;
+
+	ucCrc = _crc8_ccitt_update(0, ucType);
+	ucCrc = _crc8_ccitt_update(ucCrc, ucSeq);
+	pucAt = Telem_Stuff(pucAt, ucType);
+	pucAt = Telem_Stuff(pucAt, ucSeq);
+	for (unsigned char i = 0; i < ucCount; ++i)
+	{
+		ucCrc = _crc8_ccitt_update(ucCrc, pucPayload[i]);
+		pucAt = Telem_Stuff(pucAt, pucPayload[i]);
+	}
+	pucAt = Telem_Stuff(pucAt, ucCrc);
+	*pucAt++ = TELEM_FLAG;
+
+	return UART_Write(aucFrame, pucAt - aucFrame);
+}
+
+int Telem_Hello (void)
+{
+	unsigned char aucPay [5];
+	unsigned char * pucAt = aucPay;
+
+	*pucAt++ = TELEM_VERSION;
+	pucAt = Telem_U32(pucAt, Timer_Hz());
+	return Telem_Frame(TELEM_HELLO, aucPay, pucAt - aucPay);
+}
+
+int Telem_Time (unsigned long ulUs, unsigned long ulCs, unsigned char ucTag)
+{
+	unsigned char aucPay [9];
+	unsigned char * pucAt = aucPay;
+
+	pucAt = Telem_U32(pucAt, ulUs);
+	pucAt = Telem_U32(pucAt, ulCs);
+	*pucAt++ = ucTag;
+	return Telem_Frame(TELEM_TIME, aucPay, pucAt - aucPay);
+}
+
+int Telem_State (unsigned long ulUs, unsigned char ucState, unsigned char ucEvent, unsigned char ucNext)
+{
+	unsigned char aucPay [7];
+	unsigned char * pucAt = aucPay;
+
+	pucAt = Telem_U32(pucAt, ulUs);
+	*pucAt++ = ucState;
+	*pucAt++ = ucEvent;
+	*pucAt++ = ucNext;
+	return Telem_Frame(TELEM_STATE, aucPay, pucAt - aucPay);
+}
+
+int Telem_I2C (void)
+{
+	unsigned char aucPay [11];
+	unsigned char * pucAt = aucPay;
+	I2C_Counters counters;
+
+	I2C_GetCounters(&counters);
+	pucAt = Telem_U32(pucAt, counters.ulStarts);
+	pucAt = Telem_U32(pucAt, counters.ulBytes);
+	pucAt = Telem_U16(pucAt, counters.uiErrors);
+	*pucAt++ = UART_RxLost();
+	return Telem_Frame(TELEM_I2C, aucPay, pucAt - aucPay);
+}
+
+int Telem_Frames (unsigned long ulFrames, unsigned int uiOverruns, unsigned int uiDeferred, unsigned long ulWorstUs)
+{
+	unsigned char aucPay [12];
+	unsigned char * pucAt = aucPay;
+
+	pucAt = Telem_U32(pucAt, ulFrames);
+	pucAt = Telem_U16(pucAt, uiOverruns);
+	pucAt = Telem_U16(pucAt, uiDeferred);
+	pucAt = Telem_U32(pucAt, ulWorstUs);
+	return Telem_Frame(TELEM_FRAMES, aucPay, pucAt - aucPay);
+}
+
+int Telem_Bus (unsigned char ucLane, unsigned long ulBytes, unsigned long ulUs)
+{
+	unsigned char aucPay [9];
+	unsigned char * pucAt = aucPay;
+
+	*pucAt++ = ucLane;
+	pucAt = Telem_U32(pucAt, ulBytes);
+	pucAt = Telem_U32(pucAt, ulUs);
+	return Telem_Frame(TELEM_BUS, aucPay, pucAt - aucPay);
+}
+
+void Telem_Prof (void)
+{
+#ifdef _PROF
+	unsigned char aucPay [13];
+	Prof_Stat stat;
+
+	for (unsigned char i = 0; i < PROF_PROBES; ++i)
+	{
+		unsigned char * pucAt = aucPay;
+
+		if (!Prof_Read(i, &stat))
+			continue;
+		*pucAt++ = i;
+		pucAt = Telem_U32(pucAt, stat.ulCount);
+		pucAt = Telem_U32(pucAt, stat.ulSum);
+		pucAt = Telem_U16(pucAt, stat.uiMin);
+		pucAt = Telem_U16(pucAt, stat.uiMax);
+		(void)Telem_Frame(TELEM_PROF, aucPay, pucAt - aucPay);
+	}
+#endif
+}
+
+int Telem_Poll (void)
+{
+	unsigned char ucReq;
+	int bCounters = 0;
+
+	while (UART_Read(&ucReq))
+	{
+		if (ucReq == TELEM_REQ_HELLO)
+			(void)Telem_Hello();
+		else if (ucReq == TELEM_REQ_COUNTERS)
+		{
+			(void)Telem_I2C();
+			Telem_Prof();
+			bCounters = 1;
+		}
+	}
+	return bCounters;
+}
@@ -2,19 +2,27 @@
 // Simon Walker, NAIT
 // Revision History:
 // March 18 2022 - Initial Build
+// Oct 2026 - Software timer service, the library now owns the output
+//             compare A ISR (don't define TIMER1_COMPA_vect in the app)
+// Oct 2026 - Monotonic time (Timer_Ticks / Timer_Micros), the library also
+//             owns TIMER1_OVF_vect
+// Oct 2026 - Input capture on ICP1 (PB0) with a stamp queue, the library
+//             owns TIMER1_CAPT_vect
+// Oct 2026 - Timer_F_PWM0 handles OC0B, no longer enables the Timer0
+//             overflow interrupt (there was no handler for it)
+// Oct 2026 - Timer_Pending / Timer_Advance, so a sleep mode that stops
+//             Timer1 can skip ticks and put the time right afterwards
+// Oct 2026 - Timer_SetCpuClock can be called at runtime (clock.h), keeps
+//             time and the service tick period across the change
+// Oct 2026 - Timer_TickCount, service ticks since Timer_Init, and
+//             Timer_Capture_SetCallback (sched.h)
+// Oct 2026 - Timer_Tickless, idle sleep with the compare on the next
+//             software timer due instead of every service tick
+// Oct 2026 - TIMER_SOFT_MAX, Timer_Start returns 0 when that many software
+//             timers are running already
 
-// model of timer output compare (channel A) ISR
-/*
-// output compare A interrupt
-ISR(TIMER1_COMPA_vect)
-{
-	// rearm the output compare operation
-	OCR1A += _Timer_OC_Offset; // 1ms intervals @ prescale 64
-	
-	// up the global tick count
-	++_Ticks;
-}
-*/
+// the compare ISR rearms OCR1A by the offset given to Timer_Init, so every
+//  compare event is one service tick, and then runs the software timers
 
 typedef enum Timer_Prescale
 {
@@ -25,6 +33,12 @@ typedef enum Timer_Prescale
 	Timer_Prescale_1024 = 5
 } Timer_Prescale;
 
+typedef enum Timer_Capture_Edge
+{
+  Timer_Capture_Falling,
+  Timer_Capture_Rising
+} Timer_Capture_Edge;
+
 typedef enum Timer_PWM_Channel
 {
    Timer_PWM_Channel_OC0A,
@@ -48,8 +62,101 @@ typedef enum Timer_PWM_Pol
   Timer_PWM_Pol_Inverting
 } Timer_PWM_Pol;
 
+// software timer, storage belongs to the caller
+// pending timers are kept in a list sorted by expiry, each holding its
+//  ticks after the one before it (delta list), so the tick ISR only counts
+//  down the head of the list, but puts a periodic timer that expires back
+//  in by walking the list (up to TIMER_SOFT_MAX timers)
+// the app and the libraries arm 4 at most (LED, quiet clock, scheduler,
+//  keypad)
+#define TIMER_SOFT_MAX 8
+
+typedef void (*Timer_Callback)(void);
+
+typedef struct Timer_Soft
+{
+  struct Timer_Soft * pNext;        // next timer in the delta list
+  unsigned int uiDelta;             // ticks after the previous timer
+  unsigned int uiPeriod;            // reload in ticks, 0 for one-shot
+  Timer_Callback pCallback;         // run from the tick ISR, or NULL
+  volatile unsigned char ucPending; // expiries not yet collected (saturates)
+  unsigned char ucActive;           // in the list
+} Timer_Soft;
+
 // bring the timer up with basic OCA functionality enabled
+// uiInitialOffset is also the service tick period, in timer counts
 void Timer_Init (Timer_Prescale pre, unsigned int uiInitialOffset);
 
-// bring up timer 0 in fast PWM mode
+// tell the library the CPU clock (Hz) Timer1 is running from
+// needed by Timer_Micros, call again if the clock changes (Clock_Set does)
+// on a change the prescale is switched to keep the count rate if one can,
+//  otherwise Timer_Micros carries on from where it was at the new rate,
+//  and the service tick offset is scaled to keep its period; Timer_Ticks
+//  then counts at the new Timer_Hz, so work out spans in counts on one side
+//  of the change, and take stamps queued by the capture ISR before it
+void Timer_SetCpuClock (unsigned long ulCpuHz);
+
+// Timer1 count rate in Hz (CPU clock / prescale)
+unsigned long Timer_Hz (void);
+
+// monotonic time, Timer1 count extended by the overflow count
+// read atomically with interrupts off for a handful of cycles only
+// Timer_Ticks wraps every 2^32 counts (9.5 hours at 8us per count),
+//  Timer_Micros every 2^32us (71 minutes), differences stay valid across
+//  the wrap as long as the interval is shorter
+unsigned long Timer_Ticks (void);
+unsigned long Timer_Micros (void);
+
+// input capture on ICP1 (PB0): each edge is stamped by the hardware in
+//  ICR1 (one timer count resolution) and queued by the capture ISR
+// the noise canceler needs 4 equal samples, so it adds 4 CPU clocks of delay
+// call after Timer_Init, pull-up / DDR of PB0 beyond input is up to the app
+void Timer_Capture_Init (Timer_Capture_Edge edge, int bNoiseCancel);
+void Timer_Capture_SetEdge (Timer_Capture_Edge edge);
+
+// take the oldest captured stamp, as Timer_Ticks and / or Timer_Micros
+//  values (either pointer may be NULL), returns 0 if the queue is empty
+int Timer_Capture_Get (unsigned long * pTicks, unsigned long * pMicros);
+
+// captures lost to a full queue since the last call
+unsigned char Timer_Capture_Dropped (void);
+
+// pCallback runs in the capture ISR each time a stamp is queued (NULL for none)
+void Timer_Capture_SetCallback (Timer_Callback pCallback);
+
+// arm a software timer to expire after uiTicks service ticks, then every
+//  uiPeriod ticks (0 for one-shot), restarts it if already running
+// callbacks run in interrupt context, keep them short
+// returns 0 (timer left stopped) if TIMER_SOFT_MAX others are running
+int Timer_Start (Timer_Soft * pTimer, unsigned int uiTicks, unsigned int uiPeriod, Timer_Callback pCallback);
+
+// disarm a software timer, returns the ticks it had left (0 if not running)
+unsigned int Timer_Stop (Timer_Soft * pTimer);
+
+// collect the expiries of a timer since the last call (0 if none)
+unsigned char Timer_Expired (Timer_Soft * pTimer);
+
+// service ticks since Timer_Init, ticks skipped by Timer_Advance included
+unsigned long Timer_TickCount (void);
+
+// tickless support (power.h)
+// Timer1 counts until the next software timer is due, 0 if none is running
+unsigned long Timer_Pending (void);
+
+// move time on by ulCounts Timer1 counts that went by with Timer1 stopped
+//  (power-save), runs the service ticks that were missed on the way, so
+//  callbacks can run from here, with interrupts off
+void Timer_Advance (unsigned long ulCounts);
+
+// before an idle sleep (Timer1 keeps counting): the compare goes on to the
+//  next software timer due instead of the next tick, as far as Timer1
+//  counts in one lap (with none running, a lap), so only that wakes us.
+//  The ticks in between are counted when the compare comes, or at the
+//  next call into the library (another interrupt woke us), so time and the
+//  timers carry on as if every tick had come. Does nothing with a tick due
+//  next anyway. Call with interrupts off, right before the sleep
+void Timer_Tickless (void);
+
+// bring up timer 0 in fast PWM mode, 50% duty on the channel asked for
+// kept for existing code, pwm.h covers timers 0 and 2 with duty control
 void Timer_F_PWM0 (Timer_PWM_Channel chan, Timer_PWM_ClockSel clksel, Timer_PWM_Pol pol);
@@ -2,8 +2,72 @@
 // Simon Walker, NAIT
 
 #include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
 #include "timer.h"
 
+// output compare offset, one service tick
+static unsigned int _uiTimer_OC_Offset = 0;
+
+// head of the software timer delta list, and how many are in it
+//  (at most TIMER_SOFT_MAX, the length the ISR's re-insert may walk)
+static Timer_Soft * _pTimer_Head = 0;
+static unsigned char _ucTimer_Armed = 0;
+
+// service ticks counted since Timer_Init
+static volatile unsigned long _ulTimer_TickCount = 0;
+
+// Timer_Tickless moved the compare past the next tick, ticks are counted
+//  from the count of the last one
+static volatile unsigned char _ucTimer_Tickless = 0;
+static unsigned int _uiTimer_LastTick = 0;
+
+// Timer1 overflow count, upper bits of the monotonic time
+static volatile unsigned long _ulTimer_Ovf = 0;
+
+// prescale divider and CPU clock, for tick to time conversion
+static unsigned int _uiTimer_Div = 1;
+static unsigned long _ulTimer_CpuHz = 0;
+
+// extended count and time of the last count rate change, Timer_Micros
+//  counts on from here (both 0 until the rate changes at runtime)
+static unsigned long long _ullTimer_BaseTicks = 0;
+static unsigned long _ulTimer_BaseUs = 0;
+
+// input capture queue (power of two entries), stamps are extended counts
+#define TIMER_CAPTURE_QUEUE 8
+static volatile struct
+{
+	unsigned long ulOvf;
+	unsigned int uiCount;
+} _Timer_Capture [TIMER_CAPTURE_QUEUE];
+static volatile unsigned char _ucTimer_CapHead = 0;  // written by ISR
+static volatile unsigned char _ucTimer_CapTail = 0;  // written by reader
+static volatile unsigned char _ucTimer_CapDropped = 0;
+static Timer_Callback _pTimer_CapCallback = 0;
+
+// counts to microseconds: shift left (> 0) or right (< 0) when the ratio
+//  is a power of two, otherwise _cTimer_UsExact is 0 and we divide
+static signed char _cTimer_UsShift = 0;
+static unsigned char _cTimer_UsExact = 0;
+
+// prescale divider of a clock select
+static unsigned int Timer_Divider (Timer_Prescale pre)
+{
+	switch (pre)
+	{
+		case Timer_Prescale_1: return 1;
+		case Timer_Prescale_8: return 8;
+		case Timer_Prescale_64: return 64;
+		case Timer_Prescale_256: return 256;
+		case Timer_Prescale_1024: return 1024;
+	}
+	return 1;
+}
+
+static unsigned long Timer_ToMicros (unsigned long ulOvf, unsigned int uiCount);
+static void Timer_Catchup (void);
+
 void Timer_Init (Timer_Prescale pre, unsigned int uiInitialOffset)
 {
 	// start code will power off all modules...
@@ -16,17 +80,524 @@ void Timer_Init (Timer_Prescale pre, unsigned int uiInitialOffset)
 	TCCR1B |= pre;	// put back requested prescale bits
 	
 	// setup initial event for output compare 1 A
+	_uiTimer_OC_Offset = uiInitialOffset;
 	OCR1A = TCNT1 + uiInitialOffset;
 
-	// setup interrupt for output compare
-	// timer/counter 1, output compare A match interrupt enable
-	TIMSK1 = 0b00000010;
+	// prescale divider for the time conversions
+	_uiTimer_Div = Timer_Divider(pre);
+	if (_ulTimer_CpuHz)
+		Timer_SetCpuClock(_ulTimer_CpuHz);
+
+	// setup interrupt for output compare and overflow
+	// timer/counter 1, output compare A match interrupt enable, overflow interrupt enable
+	TIMSK1 = 0b00000011;
+}
+
+// the CPU clock changed under a running Timer1
+// must be called with interrupts off
+static void Timer_Retime (unsigned long ulCpuHz)
+{
+	unsigned long ulOldHz = Timer_Hz();
+	unsigned long ulNewHz;
+	unsigned long ulOvf;
+	unsigned int uiCount;
+	
+	// another prescale may give the same count rate (8MHz / 64 and 1MHz / 8
+	//  both count at 125kHz), then nothing counted in Timer1 counts moves
+	for (Timer_Prescale pre = Timer_Prescale_1; pre <= Timer_Prescale_1024; ++pre)
+	{
+		if (ulCpuHz % Timer_Divider(pre) == 0 && ulCpuHz / Timer_Divider(pre) == ulOldHz)
+		{
+			TCCR1B = (TCCR1B & ~0b00000111) | pre;
+			_uiTimer_Div = Timer_Divider(pre);
+			return;
+		}
+	}
+	
+	// otherwise the time so far is folded into the base at the old rate
+	ulOvf = _ulTimer_Ovf;
+	uiCount = TCNT1;
+	if ((TIFR1 & (1 << TOV1)) && uiCount < 0x8000)
+		++ulOvf;
+	_ulTimer_BaseUs = Timer_ToMicros(ulOvf, uiCount);
+	_ullTimer_BaseTicks = ((unsigned long long)ulOvf << 16) | uiCount;
+	
+	// and the service tick scaled to the same period at the new rate
+	ulNewHz = ulCpuHz / _uiTimer_Div;
+	if (ulOldHz && ulNewHz)
+	{
+		unsigned long ulOffset = ((unsigned long)_uiTimer_OC_Offset * ulNewHz + ulOldHz / 2) / ulOldHz;
+		unsigned long ulLeft = ((unsigned long)(unsigned int)(OCR1A - uiCount) * ulNewHz + ulOldHz / 2) / ulOldHz;
+		
+		_uiTimer_OC_Offset = ulOffset > 0xFFFF ? 0xFFFF : ulOffset ? (unsigned int)ulOffset : 1;
+		OCR1A = uiCount + (ulLeft > 0xFFFF ? 0xFFFF : ulLeft ? (unsigned int)ulLeft : 1);
+	}
+}
+
+void Timer_SetCpuClock (unsigned long ulCpuHz)
+{
+	unsigned long long ullNum;
+	unsigned long long ullDen = ulCpuHz;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		Timer_Catchup();
+		if (_ulTimer_CpuHz && ulCpuHz && ulCpuHz != _ulTimer_CpuHz && (TCCR1B & 0b00000111))
+			Timer_Retime(ulCpuHz);
+		_ulTimer_CpuHz = ulCpuHz;
+	}
+	
+	// microseconds per count = divider * 10^6 / CPU Hz, look for a power of two
+	ullNum = _uiTimer_Div * 1000000ULL;
+	_cTimer_UsExact = 0;
+	
+	for (signed char s = 0; s < 16 && ullDen; ++s)
+	{
+		if ((ullDen << s) == ullNum)
+		{
+			// 2^s microseconds per count
+			_cTimer_UsShift = s;
+			_cTimer_UsExact = 1;
+			return;
+		}
+		if ((ullNum << s) == ullDen)
+		{
+			// 2^s counts per microsecond
+			_cTimer_UsShift = -s;
+			_cTimer_UsExact = 1;
+			return;
+		}
+	}
+}
+
+unsigned long Timer_Hz (void)
+{
+	return _ulTimer_CpuHz / _uiTimer_Div;
+}
+
+// read the overflow count and the counter as one value
+// if the counter wrapped but the overflow ISR hasn't run yet (we have
+//  interrupts off) the TOV1 flag is still set, so account for it here
+static void Timer_Read (unsigned long * pOvf, unsigned int * pCount)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		*pOvf = _ulTimer_Ovf;
+		*pCount = TCNT1;
+		if ((TIFR1 & (1 << TOV1)) && *pCount < 0x8000)
+			++*pOvf;
+	}
+}
+
+unsigned long Timer_Ticks (void)
+{
+	unsigned long ulOvf;
+	unsigned int uiCount;
+	
+	Timer_Read(&ulOvf, &uiCount);
+	return (ulOvf << 16) | uiCount;
+}
+
+// convert an extended count (overflows, counter) to microseconds, counted
+//  on from the base (the last count rate change)
+static unsigned long Timer_ToMicros (unsigned long ulOvf, unsigned int uiCount)
+{
+	// whole microseconds per count, wraps with the tick count
+	if (_cTimer_UsExact && _cTimer_UsShift >= 0)
+		return _ulTimer_BaseUs + ((((ulOvf << 16) | uiCount) - (unsigned long)_ullTimer_BaseTicks) << _cTimer_UsShift);
+	
+	// fractional, use the full 48 bit count so the result still wraps at 2^32
+	unsigned long long ullCount = (((unsigned long long)ulOvf << 16) | uiCount) - _ullTimer_BaseTicks;
+	if (_cTimer_UsExact)
+		return _ulTimer_BaseUs + (unsigned long)(ullCount >> -_cTimer_UsShift);
+	if (!_ulTimer_CpuHz)
+		return 0;
+	return _ulTimer_BaseUs + (unsigned long)(ullCount * _uiTimer_Div * 1000000ULL / _ulTimer_CpuHz);
+}
+
+unsigned long Timer_Micros (void)
+{
+	unsigned long ulOvf;
+	unsigned int uiCount;
+	
+	Timer_Read(&ulOvf, &uiCount);
+	return Timer_ToMicros(ulOvf, uiCount);
+}
+
+// Timer1 overflow, count the upper bits of the monotonic time
+ISR(TIMER1_OVF_vect)
+{
+	++_ulTimer_Ovf;
+}
+
+// link a timer into the delta list, uiTicks from now
+// must be called with interrupts off
+static void Timer_Insert (Timer_Soft * pTimer, unsigned int uiTicks)
+{
+	Timer_Soft ** ppLink = &_pTimer_Head;
+	
+	// soonest possible expiry is the next tick
+	if (!uiTicks)
+		uiTicks = 1;
+	
+	// walk past everything due at or before us (equal expiries stay in order)
+	while (*ppLink && (*ppLink)->uiDelta <= uiTicks)
+	{
+		uiTicks -= (*ppLink)->uiDelta;
+		ppLink = &(*ppLink)->pNext;
+	}
+	
+	// the one after us is now relative to us
+	if (*ppLink)
+		(*ppLink)->uiDelta -= uiTicks;
+	
+	pTimer->uiDelta = uiTicks;
+	pTimer->pNext = *ppLink;
+	pTimer->ucActive = 1;
+	*ppLink = pTimer;
+	++_ucTimer_Armed;
+}
+
+// unlink a timer from the delta list, returns its remaining ticks
+// must be called with interrupts off
+static unsigned int Timer_Remove (Timer_Soft * pTimer)
+{
+	unsigned int uiLeft = 0;
+	
+	if (!pTimer->ucActive)
+		return 0;
+	
+	for (Timer_Soft ** ppLink = &_pTimer_Head; *ppLink; ppLink = &(*ppLink)->pNext)
+	{
+		uiLeft += (*ppLink)->uiDelta;
+		if (*ppLink == pTimer)
+		{
+			// hand our delta on to the one after us
+			if (pTimer->pNext)
+				pTimer->pNext->uiDelta += pTimer->uiDelta;
+			*ppLink = pTimer->pNext;
+			break;
+		}
+	}
+	
+	--_ucTimer_Armed;
+	pTimer->ucActive = 0;
+	pTimer->pNext = 0;
+	return uiLeft;
+}
+
+int Timer_Start (Timer_Soft * pTimer, unsigned int uiTicks, unsigned int uiPeriod, Timer_Callback pCallback)
+{
+	int iArmed = 0;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		Timer_Catchup();
+		Timer_Remove(pTimer);
+		pTimer->uiPeriod = uiPeriod;
+		pTimer->pCallback = pCallback;
+		pTimer->ucPending = 0;
+		if (_ucTimer_Armed < TIMER_SOFT_MAX)
+		{
+			Timer_Insert(pTimer, uiTicks);
+			iArmed = 1;
+		}
+	}
+	return iArmed;
+}
+
+unsigned int Timer_Stop (Timer_Soft * pTimer)
+{
+	unsigned int uiLeft;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		Timer_Catchup();
+		uiLeft = Timer_Remove(pTimer);
+	}
+	return uiLeft;
+}
+
+unsigned char Timer_Expired (Timer_Soft * pTimer)
+{
+	unsigned char ucCount;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		Timer_Catchup();
+		ucCount = pTimer->ucPending;
+		pTimer->ucPending = 0;
+	}
+	return ucCount;
+}
+
+// count uiTicks service ticks off the delta list, firing what comes due
+// only the head of the list is counted down, but a periodic expiry walks
+//  the list to go back in, so a tick costs up to TIMER_SOFT_MAX steps per
+//  periodic timer due on it
+// must be called with interrupts off
+static void Timer_Elapse (unsigned int uiTicks)
+{
+	while (_pTimer_Head && uiTicks)
+	{
+		if (_pTimer_Head->uiDelta > uiTicks)
+		{
+			_pTimer_Head->uiDelta -= uiTicks;
+			return;
+		}
+		uiTicks -= _pTimer_Head->uiDelta;
+		_pTimer_Head->uiDelta = 0;
+		
+		// fire everything that is now due
+		while (_pTimer_Head && !_pTimer_Head->uiDelta)
+		{
+			Timer_Soft * pTimer = _pTimer_Head;
+			_pTimer_Head = pTimer->pNext;
+			pTimer->pNext = 0;
+			pTimer->ucActive = 0;
+			--_ucTimer_Armed;
+			
+			if (pTimer->ucPending != 0xFF)
+				++pTimer->ucPending;
+			
+			// periodic timers go back in before the callback, so the callback
+			//  may stop or restart them
+			if (pTimer->uiPeriod)
+				Timer_Insert(pTimer, pTimer->uiPeriod);
+			
+			if (pTimer->pCallback)
+				pTimer->pCallback();
+		}
+	}
+}
+
+unsigned long Timer_TickCount (void)
+{
+	unsigned long ulCount;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		Timer_Catchup();
+		ulCount = _ulTimer_TickCount;
+	}
+	return ulCount;
+}
+
+unsigned long Timer_Pending (void)
+{
+	unsigned long ulCounts = 0;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		Timer_Catchup();
+		if (_pTimer_Head)
+		{
+			// a compare that is flagged but not serviced yet is due now
+			if (TIFR1 & (1 << OCF1A))
+				ulCounts = 1;
+			else
+				ulCounts = (unsigned long)(_pTimer_Head->uiDelta - 1) * _uiTimer_OC_Offset + (unsigned int)(OCR1A - TCNT1);
+			if (!ulCounts)
+				ulCounts = 1;
+		}
+	}
+	return ulCounts;
+}
+
+void Timer_Advance (unsigned long ulCounts)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		unsigned int uiNow;
+
+		Timer_Catchup();
+		uiNow = TCNT1;
+		
+		// counts since the last service tick, the next one is at OCR1A
+		unsigned long ulTotal = (unsigned int)(uiNow - (OCR1A - _uiTimer_OC_Offset)) + ulCounts;
+		unsigned long ulTicks = ulTotal / _uiTimer_OC_Offset;
+		unsigned int uiRem = ulTotal % _uiTimer_OC_Offset;
+		
+		// move the extended count on, carrying into the overflow count
+		//  ourselves (writing TCNT1 past the top doesn't set TOV1)
+		unsigned long ulLow = (unsigned long)uiNow + (ulCounts & 0xFFFF);
+		_ulTimer_Ovf += (ulCounts >> 16) + (ulLow >> 16);
+		TCNT1 = (unsigned int)ulLow;
+		
+		// keep the service tick phase, a tick that was already flagged is
+		//  in ulTicks, so drop the flag
+		OCR1A = (unsigned int)ulLow - uiRem + _uiTimer_OC_Offset;
+		TIFR1 = (1 << OCF1A);
+		
+		_ulTimer_TickCount += ulTicks;
+		Timer_Elapse(ulTicks > 0xFFFF ? 0xFFFF : (unsigned int)ulTicks);
+	}
+}
+
+// count the ticks that went by since Timer_Tickless and put the compare
+//  back on the next tick
+// must be called with interrupts off
+static void Timer_Catchup (void)
+{
+	unsigned int uiTicks;
+
+	if (!_ucTimer_Tickless)
+		return;
+	_ucTimer_Tickless = 0;
+
+	// less than a lap since the last tick, the compare was inside it
+	uiTicks = (unsigned int)(TCNT1 - _uiTimer_LastTick) / _uiTimer_OC_Offset;
+	OCR1A = _uiTimer_LastTick + (uiTicks + 1) * _uiTimer_OC_Offset;
+	TIFR1 = (1 << OCF1A);
+
+	_ulTimer_TickCount += uiTicks;
+	Timer_Elapse(uiTicks);
+}
+
+void Timer_Tickless (void)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		unsigned int uiLap = 0xFFFF / _uiTimer_OC_Offset;
+		unsigned int uiTicks = _pTimer_Head ? _pTimer_Head->uiDelta : uiLap;
+
+		if (uiTicks > uiLap)
+			uiTicks = uiLap;
+
+		// a tick that is flagged already is counted the usual way
+		if (!_ucTimer_Tickless && uiTicks > 1 && !(TIFR1 & (1 << OCF1A)))
+		{
+			_uiTimer_LastTick = OCR1A - _uiTimer_OC_Offset;
+			OCR1A = _uiTimer_LastTick + uiTicks * _uiTimer_OC_Offset;
+			_ucTimer_Tickless = 1;
+		}
+	}
+}
+
+// output compare A interrupt, one service tick, or the ticks since
+//  Timer_Tickless
+ISR(TIMER1_COMPA_vect)
+{
+	if (_ucTimer_Tickless)
+	{
+		Timer_Catchup();
+		return;
+	}
+
+	// rearm the output compare operation
+	OCR1A += _uiTimer_OC_Offset;
+	
+	++_ulTimer_TickCount;
+	Timer_Elapse(1);
+}
+
+void Timer_Capture_Init (Timer_Capture_Edge edge, int bNoiseCancel)
+{
+	// ICP1 (PB0) is an input
+	DDRB &= ~(1 << DDB0);
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		// noise canceler and edge select, keep the clock select bits
+		TCCR1B &= ~((1 << ICNC1) | (1 << ICES1));
+		if (bNoiseCancel)
+			TCCR1B |= (1 << ICNC1);
+		if (edge == Timer_Capture_Rising)
+			TCCR1B |= (1 << ICES1);
+		
+		// flush the queue and any stale capture, then enable the interrupt
+		_ucTimer_CapHead = _ucTimer_CapTail = 0;
+		_ucTimer_CapDropped = 0;
+		TIFR1 = (1 << ICF1);
+		TIMSK1 |= (1 << ICIE1);
+	}
+}
+
+void Timer_Capture_SetEdge (Timer_Capture_Edge edge)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		if (edge == Timer_Capture_Rising)
+			TCCR1B |= (1 << ICES1);
+		else
+			TCCR1B &= ~(1 << ICES1);
+		
+		// changing the edge can flag a capture, drop it
+		TIFR1 = (1 << ICF1);
+	}
+}
+
+int Timer_Capture_Get (unsigned long * pTicks, unsigned long * pMicros)
+{
+	unsigned char ucTail = _ucTimer_CapTail;
+	
+	if (ucTail == _ucTimer_CapHead)
+		return 0;
+	
+	// only the ISR writes at head, so the entry is stable once published
+	unsigned long ulOvf = _Timer_Capture[ucTail].ulOvf;
+	unsigned int uiCount = _Timer_Capture[ucTail].uiCount;
+	_ucTimer_CapTail = (ucTail + 1) & (TIMER_CAPTURE_QUEUE - 1);
+	
+	if (pTicks)
+		*pTicks = (ulOvf << 16) | uiCount;
+	if (pMicros)
+		*pMicros = Timer_ToMicros(ulOvf, uiCount);
+	return 1;
+}
+
+unsigned char Timer_Capture_Dropped (void)
+{
+	unsigned char ucDropped;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		ucDropped = _ucTimer_CapDropped;
+		_ucTimer_CapDropped = 0;
+	}
+	return ucDropped;
+}
+
+void Timer_Capture_SetCallback (Timer_Callback pCallback)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		_pTimer_CapCallback = pCallback;
+	}
+}
+
+// input capture, queue the stamp of the edge
+ISR(TIMER1_CAPT_vect)
+{
+	unsigned int uiCount = ICR1;
+	unsigned long ulOvf = _ulTimer_Ovf;
+	
+	// the edge came after a wrap whose overflow ISR hasn't run yet
+	if ((TIFR1 & (1 << TOV1)) && uiCount < 0x8000)
+		++ulOvf;
+	
+	unsigned char ucHead = _ucTimer_CapHead;
+	unsigned char ucNext = (ucHead + 1) & (TIMER_CAPTURE_QUEUE - 1);
+	if (ucNext == _ucTimer_CapTail)
+	{
+		// full, keep the oldest stamps
+		if (_ucTimer_CapDropped != 0xFF)
+			++_ucTimer_CapDropped;
+		return;
+	}
+	
+	_Timer_Capture[ucHead].ulOvf = ulOvf;
+	_Timer_Capture[ucHead].uiCount = uiCount;
+	_ucTimer_CapHead = ucNext;
+	if (_pTimer_CapCallback)
+		_pTimer_CapCallback();
 }
 
 void Timer_F_PWM0 (Timer_PWM_Channel chan, Timer_PWM_ClockSel clksel, Timer_PWM_Pol pol)
 {
   // setup fast PWM mode (closest to what we did in micro)
   // want 'negative polarity', so start low, go high on match, go low at end of period
+  // (pwm.h has the full engine, both timers, duty and frequency control)
 
   // start code will power off all modules...
   // ensure power is on : Timer 0
@@ -38,26 +609,38 @@ void Timer_F_PWM0 (Timer_PWM_Channel chan, Timer_PWM_ClockSel clksel, Timer_PWM_
     // (14.9.1) register, DDR comment      
     if (pol == Timer_PWM_Pol_NonInverting)
     {
-      TCCR0A = 0b10000011;  // fast pwm (mode 3), channel OC0A (14.7.3), non-inverting mode
+      TCCR0A = (TCCR0A & 0b00110000) | 0b10000011;  // fast pwm (mode 3), channel OC0A (14.7.3), non-inverting mode
       // non-inverting is like +'ve polarity on 9S12
     }
     else
     {
-      TCCR0A = 0b11000011;  // fast pwm (mode 3), channel OC0A (14.7.3), inverting mode
+      TCCR0A = (TCCR0A & 0b00110000) | 0b11000011;  // fast pwm (mode 3), channel OC0A (14.7.3), inverting mode
       // inverting is like -'ve polarity on 9S12
     }   
-                          
-    TCCR0B = clksel;      // set the desired clock
-    // start with 50% duty
     
+    // start with 50% duty
     OCR0A = 0x7F;
     
-    // pin must be marked as output
+    // pin must be marked as output (PD6)
     // (14.9.1) register, DDR comment
     DDRD |= 0b01000000;
+  }
+  else // OC0B
+  {
+    if (pol == Timer_PWM_Pol_NonInverting)
+      TCCR0A = (TCCR0A & 0b11000000) | 0b00100011;  // fast pwm (mode 3), channel OC0B, non-inverting mode
+    else
+      TCCR0A = (TCCR0A & 0b11000000) | 0b00110011;  // fast pwm (mode 3), channel OC0B, inverting mode
     
-    // setup interrupts
-    TIMSK0 |= 0b00000001;
+    // start with 50% duty
+    OCR0B = 0x7F;
+    
+    // pin must be marked as output (PD5)
+    DDRD |= 0b00100000;
   }
+                        
+  TCCR0B = clksel;      // set the desired clock
+  
+  // no interrupts, the waveform is all hardware (an enabled interrupt
+  //  with no handler would reset the chip)
 }
-
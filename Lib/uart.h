@@ -0,0 +1,51 @@
+// UART library, ATmega328P Version
+// Revision History:
+// Oct 2026 - Initial Build, USART0 8N1 with interrupt driven TX/RX rings
+// Oct 2026 - UART_SetBusRate for clock changes (clock.h)
+// Oct 2026 - UART_SetRxCallback, a byte received can release a task (sched.h)
+
+// nothing here blocks: UART_Write queues a whole block or nothing, the
+//  data register empty interrupt sends it out, received bytes are queued
+//  by the receive interrupt until UART_Read takes them
+// TXD is PD1, RXD is PD0
+// the library owns USART_UDRE_vect and USART_RX_vect
+// USART interrupts only wake the CPU from idle, keep out of power-save
+//  while UART_Busy (or a received byte is lost)
+
+#ifndef UART_TX_SIZE
+#define UART_TX_SIZE 64   // transmit ring (power of two, 256 or less)
+#endif
+#ifndef UART_RX_SIZE
+#define UART_RX_SIZE 16   // receive ring (power of two, 256 or less)
+#endif
+
+// 8N1 at ulBaud, double speed when that is closer
+// returns -1 if the baud rate is more than 2% out at this bus rate
+int UART_Init (unsigned long ulBusRate, unsigned long ulBaud);
+
+// the same baud rate at a new bus (CPU) rate, call once nothing is sending
+// returns -1 if it is more than 2% out at this bus rate, the USART is then
+//  off (nothing sent or received, UART_Write still queues while there is
+//  room) until a bus rate that has it comes back
+int UART_SetBusRate (unsigned long ulBusRate);
+
+// bytes that will fit in the transmit ring now
+unsigned char UART_Free (void);
+
+// queue ucCount bytes to send, all of them or none
+// returns 0 if they don't fit
+int UART_Write (const unsigned char * pucData, unsigned char ucCount);
+
+// take the oldest received byte, returns 0 if there is none
+int UART_Read (unsigned char * pucData);
+
+// pCallback runs in the receive ISR each time a byte is queued (NULL for none)
+typedef void (*UART_Callback)(void);
+void UART_SetRxCallback (UART_Callback pCallback);
+
+// still sending
+int UART_Busy (void);
+
+// received bytes lost to a full ring or a late read (data overrun, frame
+//  errors) since the last call
+unsigned char UART_RxLost (void);
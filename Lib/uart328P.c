@@ -0,0 +1,222 @@
+// UART Library
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include "uart.h"
+
+// rings, head written by the producer, tail by the consumer
+static volatile unsigned char _aucUART_Tx [UART_TX_SIZE];
+static volatile unsigned char _ucUART_TxHead = 0;   // written by Write
+static volatile unsigned char _ucUART_TxTail = 0;   // written by ISR
+static volatile unsigned char _ucUART_Sending = 0;  // a byte went out since TXC0 was last seen
+
+static volatile unsigned char _aucUART_Rx [UART_RX_SIZE];
+static volatile unsigned char _ucUART_RxHead = 0;   // written by ISR
+static volatile unsigned char _ucUART_RxTail = 0;   // written by Read
+static volatile unsigned char _ucUART_RxLost = 0;
+
+static unsigned long _ulUART_Baud = 0;
+static unsigned char _ucUART_Off = 0;   // the baud rate can't be had at this bus rate
+static UART_Callback _pUART_RxCallback = 0;
+
+// divider for a baud rate, 16 or 8 (double speed) clocks a bit
+static unsigned long UART_Divider (unsigned long ulBusRate, unsigned long ulBaud, unsigned char ucClocks)
+{
+	return (ulBusRate + (unsigned long)ucClocks * ulBaud / 2) / ((unsigned long)ucClocks * ulBaud);
+}
+
+// error of a divider in tenths of a percent
+static unsigned long UART_Error (unsigned long ulBusRate, unsigned long ulBaud, unsigned char ucClocks, unsigned long ulDiv)
+{
+	unsigned long ulActual = ulBusRate / ((unsigned long)ucClocks * ulDiv);
+
+	return (ulActual > ulBaud ? ulActual - ulBaud : ulBaud - ulActual) * 1000 / ulBaud;
+}
+
+// UBRR0 and U2X0 for a baud rate, returns 0 if it is more than 2% out
+static unsigned int UART_Setting (unsigned long ulBusRate, unsigned long ulBaud, int * pbDouble)
+{
+	unsigned long ulDiv16 = UART_Divider(ulBusRate, ulBaud, 16);
+	unsigned long ulDiv8 = UART_Divider(ulBusRate, ulBaud, 8);
+	unsigned long ulErr16 = ulDiv16 ? UART_Error(ulBusRate, ulBaud, 16, ulDiv16) : 1000;
+	unsigned long ulErr8 = ulDiv8 ? UART_Error(ulBusRate, ulBaud, 8, ulDiv8) : 1000;
+	int bDouble = ulErr8 < ulErr16;
+
+	if ((bDouble ? ulErr8 : ulErr16) > 20 || (bDouble ? ulDiv8 : ulDiv16) > 4096)
+		return 0;
+	*pbDouble = bDouble;
+	return bDouble ? ulDiv8 : ulDiv16;
+}
+
+int UART_Init (unsigned long ulBusRate, unsigned long ulBaud)
+{
+	int bDouble = 0;
+	unsigned int uiDiv = UART_Setting(ulBusRate, ulBaud, &bDouble);
+
+	if (!uiDiv)
+		return -1;
+
+	// start will power off all modules...
+	// ensure power is on : USART0
+	PRR &= ~(1 << PRUSART0);
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		UCSR0B = 0;
+		UBRR0 = uiDiv - 1;
+		UCSR0A = bDouble ? 1 << U2X0 : 0;
+		UCSR0C = (1 << UCSZ01) | (1 << UCSZ00);   // async, 8N1
+
+		_ucUART_TxHead = _ucUART_TxTail = 0;
+		_ucUART_Sending = 0;
+		_ucUART_RxHead = _ucUART_RxTail = 0;
+		_ucUART_RxLost = 0;
+		_ulUART_Baud = ulBaud;
+		_ucUART_Off = 0;
+
+		// UDRIE only while there is something to send
+		UCSR0B = (1 << RXCIE0) | (1 << RXEN0) | (1 << TXEN0);
+	}
+	return 0;
+}
+
+int UART_SetBusRate (unsigned long ulBusRate)
+{
+	int bDouble = 0;
+	unsigned int uiDiv = UART_Setting(ulBusRate, _ulUART_Baud, &bDouble);
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		if (!uiDiv)
+		{
+			// off until a bus rate that has the baud rate comes back, the ring
+			//  keeps what was queued
+			UCSR0B = 0;
+			_ucUART_Sending = 0;
+			_ucUART_Off = 1;
+		}
+		else
+		{
+			UBRR0 = uiDiv - 1;
+			UCSR0A = bDouble ? 1 << U2X0 : 0;
+			UCSR0B = (1 << RXCIE0) | (1 << RXEN0) | (1 << TXEN0);
+			if (_ucUART_TxHead != _ucUART_TxTail)
+				UCSR0B |= 1 << UDRIE0;
+			_ucUART_Off = 0;
+		}
+	}
+	return uiDiv ? 0 : -1;
+}
+
+unsigned char UART_Free (void)
+{
+	return (UART_TX_SIZE - 1) - ((_ucUART_TxHead - _ucUART_TxTail) & (UART_TX_SIZE - 1));
+}
+
+int UART_Write (const unsigned char * pucData, unsigned char ucCount)
+{
+	unsigned char ucHead = _ucUART_TxHead;
+
+	if (ucCount > UART_Free())
+		return 0;
+
+	// only the ISR reads the ring, and not past head
+	while (ucCount--)
+	{
+		_aucUART_Tx[ucHead] = *pucData++;
+		ucHead = (ucHead + 1) & (UART_TX_SIZE - 1);
+	}
+	_ucUART_TxHead = ucHead;
+
+	if (!_ucUART_Off)
+		UCSR0B |= 1 << UDRIE0;     // fires straight away if UDR0 is empty
+	return 1;
+}
+
+int UART_Read (unsigned char * pucData)
+{
+	unsigned char ucTail = _ucUART_RxTail;
+
+	if (ucTail == _ucUART_RxHead)
+		return 0;
+
+	*pucData = _aucUART_Rx[ucTail];
+	_ucUART_RxTail = (ucTail + 1) & (UART_RX_SIZE - 1);
+	return 1;
+}
+
+void UART_SetRxCallback (UART_Callback pCallback)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		_pUART_RxCallback = pCallback;
+	}
+}
+
+int UART_Busy (void)
+{
+	int bBusy;
+
+	// the last byte is still in the shift register until TXC0
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		if (_ucUART_Sending && (UCSR0A & (1 << TXC0)) && !(UCSR0B & (1 << UDRIE0)))
+			_ucUART_Sending = 0;
+		bBusy = _ucUART_Sending || (UCSR0B & (1 << UDRIE0));
+	}
+	return bBusy;
+}
+
+unsigned char UART_RxLost (void)
+{
+	unsigned char ucLost;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		ucLost = _ucUART_RxLost;
+		_ucUART_RxLost = 0;
+	}
+	return ucLost;
+}
+
+// data register empty, next byte out
+ISR(USART_UDRE_vect)
+{
+	unsigned char ucTail = _ucUART_TxTail;
+
+	if (ucTail == _ucUART_TxHead)
+	{
+		// drained, the interrupt would fire for as long as UDR0 is empty
+		UCSR0B &= ~(1 << UDRIE0);
+		return;
+	}
+
+	// TXC0 is cleared by writing 1 (FE0, DOR0 and UPE0 must be written 0),
+	//  set again once this byte is out
+	UCSR0A = (UCSR0A & (1 << U2X0)) | (1 << TXC0);
+	UDR0 = _aucUART_Tx[ucTail];
+	_ucUART_Sending = 1;
+	_ucUART_TxTail = (ucTail + 1) & (UART_TX_SIZE - 1);
+}
+
+// byte received
+ISR(USART_RX_vect)
+{
+	unsigned char ucStatus = UCSR0A;
+	unsigned char ucData = UDR0;   // read after the status, clears RXC0
+	unsigned char ucNext = (_ucUART_RxHead + 1) & (UART_RX_SIZE - 1);
+
+	if ((ucStatus & ((1 << FE0) | (1 << DOR0))) || ucNext == _ucUART_RxTail)
+	{
+		if (_ucUART_RxLost != 0xFF)
+			++_ucUART_RxLost;
+		if (ucNext == _ucUART_RxTail || (ucStatus & (1 << FE0)))
+			return;
+	}
+
+	_aucUART_Rx[_ucUART_RxHead] = ucData;
+	_ucUART_RxHead = ucNext;
+	if (_pUART_RxCallback)
+		_pUART_RxCallback();
+}
@@ -0,0 +1,185 @@
+// Benchmark runner, Linux host with simavr
+// Revision History:
+// Oct 2026 - Initial Build, runs a Build/bench firmware and prints its
+//             cycle counts
+// Oct 2026 - PC0 / PC1 pulled up, for a software I2C bus
+//
+// runs a benchmark firmware (Build/bench/bench.h) on a simulated ATmega328P
+//  at BENCH_HZ, with an I2C slave on the TWI that ACKs every address and
+//  byte and reads 0x00, and prints one line per run the firmware counts:
+//   bench tag=<tag> name=<call> calls=<n> cycles=<n> per_call=<n>
+//  and one when it ends:
+//   done tag=<tag> cycles=<n> status=ok|crashed|timeout
+// cycles are the simulator's own count, per_call is rounded to the nearest
+//  cycle. An address given with -n is NACKed instead (a missing device)
+// PC0 and PC1 read high unless the firmware drives them (a software I2C
+//  bus's pull-ups, there is no slave on it)
+//
+// build: gcc -O2 -Wall -I/usr/include/simavr -o simbench Tools/simbench.c -lsimavr -lelf
+// use:   simbench [-t tag] [-n addr] [-m max cycles] bench_lcd.elf
+//  (Build/Makefile builds it and runs the lot with make bench)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "sim_avr.h"
+#include "sim_elf.h"
+#include "sim_io.h"
+#include "avr_twi.h"
+#include "avr_ioport.h"
+#include "../Build/bench/bench.h"
+
+// data space addresses of the registers bench.h uses
+#define BENCH_TEXT_ADDR 0x3E    // GPIOR0
+#define BENCH_MARK_ADDR 0x4A    // GPIOR1
+
+static const char * _szTag = "bench";
+
+// the run's text, and its cycles so far
+static char _acLine [256];
+static unsigned int _uiLine = 0;
+static avr_cycle_count_t _ullCycles = 0;
+static avr_cycle_count_t _ullFrom = 0;
+static int _bCounting = 0;
+
+// the TWI slave's IRQs, and is it in a transaction
+static avr_irq_t * _pSlave = 0;
+static int _bSelected = 0;
+static int _iNack = -1;
+
+static const char * _aszSlaveIrq [2] =
+{
+	[TWI_IRQ_INPUT] = "8>simbench.twi.out",
+	[TWI_IRQ_OUTPUT] = "32<simbench.twi.in"
+};
+
+static void Text (struct avr_t * avr, avr_io_addr_t addr, uint8_t v, void * param)
+{
+	avr->data[addr] = v;
+	if (_uiLine < sizeof _acLine - 1)
+		_acLine[_uiLine++] = v;
+}
+
+static void Mark (struct avr_t * avr, avr_io_addr_t addr, uint8_t v, void * param)
+{
+	const char * pCalls;
+	unsigned long ulCalls = 0;
+
+	avr->data[addr] = v;
+
+	if (_bCounting)
+		_ullCycles += avr->cycle - _ullFrom;
+	_bCounting = v == BENCH_RUN;
+	_ullFrom = avr->cycle;
+	if (v != BENCH_END)
+		return;
+
+	_acLine[_uiLine] = 0;
+	pCalls = strstr(_acLine, "calls=");
+	if (pCalls)
+		ulCalls = strtoul(pCalls + 6, 0, 10);
+	printf("bench tag=%s %s cycles=%llu per_call=%llu\n", _szTag, _acLine,
+		(unsigned long long)_ullCycles,
+		ulCalls ? (unsigned long long)((_ullCycles + ulCalls / 2) / ulCalls) : 0ULL);
+	fflush(stdout);
+
+	_uiLine = 0;
+	_ullCycles = 0;
+}
+
+// a TWI condition from the AVR, answered on the input IRQ
+static void Slave (struct avr_irq_t * irq, uint32_t value, void * param)
+{
+	avr_twi_msg_irq_t v;
+
+	v.u.v = value;
+	if (v.u.twi.msg & TWI_COND_STOP)
+		_bSelected = 0;
+
+	// the address comes with the START (8-bit, R/W in bit 0)
+	if (v.u.twi.msg & TWI_COND_START)
+	{
+		_bSelected = (v.u.twi.addr >> 1) != _iNack;
+		if (_bSelected)
+			avr_raise_irq(_pSlave + TWI_IRQ_INPUT, avr_twi_irq_msg(TWI_COND_ACK, v.u.twi.addr, 1));
+	}
+
+	if (!_bSelected)
+		return;
+	if (v.u.twi.msg & TWI_COND_WRITE)
+		avr_raise_irq(_pSlave + TWI_IRQ_INPUT, avr_twi_irq_msg(TWI_COND_ACK, v.u.twi.addr, 1));
+	if (v.u.twi.msg & TWI_COND_READ)
+		avr_raise_irq(_pSlave + TWI_IRQ_INPUT, avr_twi_irq_msg(TWI_COND_READ, v.u.twi.addr, 0x00));
+}
+
+int main (int argc, char ** argv)
+{
+	unsigned long long ullMax = 2000000000ULL;   // 125s at 16MHz
+	elf_firmware_t fw;
+	avr_t * avr;
+	int iState = cpu_Running;
+	int iOpt;
+
+	while ((iOpt = getopt(argc, argv, "t:n:m:")) != -1)
+	{
+		if (iOpt == 't')
+			_szTag = optarg;
+		else if (iOpt == 'n')
+			_iNack = (int)strtol(optarg, 0, 0);
+		else if (iOpt == 'm')
+			ullMax = strtoull(optarg, 0, 0);
+		else
+		{
+			fprintf(stderr, "use: %s [-t tag] [-n addr] [-m max cycles] firmware.elf\n", argv[0]);
+			return 2;
+		}
+	}
+	if (optind != argc - 1)
+	{
+		fprintf(stderr, "use: %s [-t tag] [-n addr] [-m max cycles] firmware.elf\n", argv[0]);
+		return 2;
+	}
+
+	memset(&fw, 0, sizeof fw);
+	if (elf_read_firmware(argv[optind], &fw))
+	{
+		fprintf(stderr, "%s: can't load\n", argv[optind]);
+		return 1;
+	}
+	strcpy(fw.mmcu, "atmega328p");
+	fw.frequency = BENCH_HZ;
+
+	avr = avr_make_mcu_by_name(fw.mmcu);
+	if (!avr)
+	{
+		fprintf(stderr, "simavr has no %s\n", fw.mmcu);
+		return 1;
+	}
+	avr_init(avr);
+	avr_load_firmware(avr, &fw);
+
+	// external pull-ups, an input pin reads them
+	{
+		avr_ioport_external_t ext = { .name = 'C', .mask = 0x03, .value = 0x03 };
+
+		avr_ioctl(avr, AVR_IOCTL_IOPORT_SET_EXTERNAL('C'), &ext);
+	}
+
+	avr_register_io_write(avr, BENCH_TEXT_ADDR, Text, 0);
+	avr_register_io_write(avr, BENCH_MARK_ADDR, Mark, 0);
+
+	_pSlave = avr_alloc_irq(&avr->irq_pool, 0, 2, _aszSlaveIrq);
+	avr_irq_register_notify(_pSlave + TWI_IRQ_OUTPUT, Slave, 0);
+	avr_connect_irq(_pSlave + TWI_IRQ_INPUT, avr_io_getirq(avr, AVR_IOCTL_TWI_GETIRQ(0), TWI_IRQ_INPUT));
+	avr_connect_irq(avr_io_getirq(avr, AVR_IOCTL_TWI_GETIRQ(0), TWI_IRQ_OUTPUT), _pSlave + TWI_IRQ_OUTPUT);
+
+	// Bench_Done sleeps with interrupts off, simavr calls that done
+	while (iState != cpu_Done && iState != cpu_Crashed && avr->cycle < ullMax)
+		iState = avr_run(avr);
+
+	printf("done tag=%s cycles=%llu status=%s\n", _szTag, (unsigned long long)avr->cycle,
+		iState == cpu_Done ? "ok" : (iState == cpu_Crashed ? "crashed" : "timeout"));
+	avr_terminate(avr);
+	return iState == cpu_Done ? 0 : 1;
+}
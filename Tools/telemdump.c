@@ -0,0 +1,294 @@
+// Telemetry decoder, Linux host
+// Revision History:
+// Oct 2026 - Initial Build, decodes the telem.h frame stream
+// Oct 2026 - Display frame counters
+// Oct 2026 - Scheduler task counters
+// Oct 2026 - SRAM use
+// Oct 2026 - I2C lane throughput
+//
+// reads the stopwatch telemetry from a serial device (set raw, 8N1 at the
+//  baud rate given) or from a recorded file ("-" for stdin), and prints one
+//  line per frame:
+//   <seconds> <TYPE> key=value ...
+// seconds are from the frame's own time stamp where it has one, unwrapped
+//  across the 71 minute Timer_Micros wrap. Bad frames (CRC, length) and
+//  frames the target had to drop (sequence gaps) are counted and shown at
+//  the end
+//
+// build: gcc -O2 -Wall -o telemdump Tools/telemdump.c
+// use:   telemdump [-b baud] [-r] /dev/ttyUSB0
+//        cat capture.bin | telemdump -
+//   -r asks the target for a hello and its counters on start (serial only)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include "../Lib/telem.h"
+
+// names for the stopwatch's states and events (main.c enum States / Events)
+static const char * _aszState [] = { "IDLE", "RUN", "STOP", "RESET", "REVIEW" };
+static const char * _aszEvent [] = { "LEFT", "RIGHT", "ICP", "HOLD" };
+static const char * _aszTask [] = { "INPUT", "FOLD", "RENDER", "TELEM", "BENCH" };
+static const char * _aszLane [] = { "OLED", "LCD", "BOTH" };
+
+static unsigned long _ulHz = 0;         // Timer1 counts a second, from the hello
+static unsigned long long _ullUs = 0;   // unwrapped time of the last stamp
+static unsigned long _ulLastUs = 0;
+static int _bHaveUs = 0;
+
+static unsigned long _ulFrames = 0;
+static unsigned long _ulBad = 0;
+static unsigned long _ulDropped = 0;
+static int _iLastSeq = -1;
+
+static unsigned char Crc8 (unsigned char ucCrc, unsigned char ucData)
+{
+	ucCrc ^= ucData;
+	for (int i = 0; i < 8; ++i)
+		ucCrc = (ucCrc & 0x80) ? (unsigned char)((ucCrc << 1) ^ 0x07) : (unsigned char)(ucCrc << 1);
+	return ucCrc;
+}
+
+static unsigned int U16 (const unsigned char * p)
+{
+	return p[0] | ((unsigned int)p[1] << 8);
+}
+
+static unsigned long U32 (const unsigned char * p)
+{
+	return U16(p) | ((unsigned long)U16(p + 2) << 16);
+}
+
+static const char * Name (const char ** pszNames, unsigned int uiCount, unsigned char ucIndex)
+{
+	return ucIndex < uiCount ? pszNames[ucIndex] : "?";
+}
+
+// a frame time stamp, carried on from the last one
+static double Stamp (unsigned long ulUs)
+{
+	if (_bHaveUs)
+		_ullUs += (uint32_t)(ulUs - _ulLastUs);   // the target's 32-bit wrap
+	else
+		_ullUs = ulUs;
+	_ulLastUs = ulUs;
+	_bHaveUs = 1;
+	return _ullUs / 1e6;
+}
+
+static double Now (void)
+{
+	return _ullUs / 1e6;
+}
+
+// Timer1 counts to microseconds, or raw counts before a hello
+static double Micros (unsigned long ulCounts)
+{
+	return _ulHz ? ulCounts * 1e6 / _ulHz : (double)ulCounts;
+}
+
+static int Decode (const unsigned char * pucFrame, int iCount)
+{
+	const unsigned char * p = pucFrame + 2;
+	int iPay = iCount - 3;
+	unsigned char ucCrc = 0;
+
+	if (iCount < 3)
+		return 0;
+	for (int i = 0; i < iCount - 1; ++i)
+		ucCrc = Crc8(ucCrc, pucFrame[i]);
+	if (ucCrc != pucFrame[iCount - 1])
+		return 0;
+
+	// every frame counts, so a gap is frames the target dropped
+	if (_iLastSeq >= 0)
+		_ulDropped += (unsigned char)(pucFrame[1] - _iLastSeq - 1);
+	_iLastSeq = pucFrame[1];
+
+	switch (pucFrame[0])
+	{
+		case TELEM_HELLO:
+			if (iPay != 5)
+				return 0;
+			_ulHz = U32(p + 1);
+			printf("%.6f HELLO version=%u timer_hz=%lu\n", Now(), p[0], _ulHz);
+			break;
+		case TELEM_TIME:
+			if (iPay != 9)
+				return 0;
+			printf("%.6f TIME cs=%lu tag=%u\n", Stamp(U32(p)), U32(p + 4), p[8]);
+			break;
+		case TELEM_STATE:
+			if (iPay != 7)
+				return 0;
+			printf("%.6f STATE %s %s -> %s\n", Stamp(U32(p)), Name(_aszState, 5, p[4]), Name(_aszEvent, 4, p[5]), Name(_aszState, 5, p[6]));
+			break;
+		case TELEM_PROF:
+			if (iPay != 13)
+				return 0;
+			{
+				unsigned long ulSpans = U32(p + 1);
+
+				printf("%.6f PROF id=%u spans=%lu min=%.1f avg=%.1f max=%.1f%s\n", Now(), p[0], ulSpans, Micros(U16(p + 9)), ulSpans ? Micros(U32(p + 5)) / ulSpans : 0.0, Micros(U16(p + 11)), _ulHz ? "" : " (counts)");
+			}
+			break;
+		case TELEM_I2C:
+			if (iPay != 11)
+				return 0;
+			printf("%.6f I2C starts=%lu bytes=%lu errors=%u uart_lost=%u\n", Now(), U32(p), U32(p + 4), U16(p + 8), p[10]);
+			break;
+		case TELEM_FRAMES:
+			if (iPay != 12)
+				return 0;
+			printf("%.6f FRAMES frames=%lu overruns=%u deferred=%u worst_us=%lu\n", Now(), U32(p), U16(p + 4), U16(p + 6), U32(p + 8));
+			break;
+		case TELEM_TASK:
+			if (iPay != 11)
+				return 0;
+			printf("%.6f TASK %s runs=%lu worst_us=%lu misses=%u\n", Now(), Name(_aszTask, 5, p[0]), U32(p + 1), U32(p + 5), U16(p + 9));
+			break;
+		case TELEM_MEM:
+			if (iPay != 9)
+				return 0;
+			printf("%.6f MEM static=%u gap=%u least_gap=%u stack_peak=%u%s\n", Now(), U16(p), U16(p + 2), U16(p + 4), U16(p + 6), p[8] ? " ALARM" : "");
+			break;
+		case TELEM_BUS:
+			if (iPay != 9)
+				return 0;
+			printf("%.6f BUS %s bytes=%lu us=%lu bytes_per_s=%lu\n", Now(), Name(_aszLane, 3, p[0]), U32(p + 1), U32(p + 5),
+				U32(p + 5) ? (unsigned long)((unsigned long long)U32(p + 1) * 1000000 / U32(p + 5)) : 0UL);
+			break;
+		default:
+			printf("%.6f UNKNOWN type=0x%02X bytes=%d\n", Now(), pucFrame[0], iPay);
+			break;
+	}
+	fflush(stdout);
+	return 1;
+}
+
+static speed_t Speed (long lBaud)
+{
+	switch (lBaud)
+	{
+		case 9600: return B9600;
+		case 19200: return B19200;
+		case 38400: return B38400;
+		case 57600: return B57600;
+		case 115200: return B115200;
+		default: return 0;
+	}
+}
+
+int main (int argc, char ** argv)
+{
+	long lBaud = 38400;
+	int bRequest = 0;
+	int iOpt;
+	int fd;
+	unsigned char aucFrame [TELEM_PAYLOAD + 3];
+	int iAt = 0;
+	int bEsc = 0;
+	int bLong = 0;
+	int bSync = 0;
+
+	while ((iOpt = getopt(argc, argv, "b:r")) != -1)
+	{
+		if (iOpt == 'b')
+			lBaud = strtol(optarg, 0, 10);
+		else if (iOpt == 'r')
+			bRequest = 1;
+		else
+		{
+			fprintf(stderr, "use: %s [-b baud] [-r] device|file|-\n", argv[0]);
+			return 2;
+		}
+	}
+	if (optind != argc - 1)
+	{
+		fprintf(stderr, "use: %s [-b baud] [-r] device|file|-\n", argv[0]);
+		return 2;
+	}
+
+	fd = strcmp(argv[optind], "-") ? open(argv[optind], O_RDWR | O_NOCTTY) : 0;
+	if (fd < 0)
+		fd = open(argv[optind], O_RDONLY);   // a recorded file we can't write
+	if (fd < 0)
+	{
+		perror(argv[optind]);
+		return 1;
+	}
+
+	if (isatty(fd))
+	{
+		struct termios tio;
+
+		if (!Speed(lBaud) || tcgetattr(fd, &tio))
+		{
+			fprintf(stderr, "%s: can't set %ld baud\n", argv[optind], lBaud);
+			return 1;
+		}
+		cfmakeraw(&tio);
+		cfsetispeed(&tio, Speed(lBaud));
+		cfsetospeed(&tio, Speed(lBaud));
+		tio.c_cflag |= CLOCAL | CREAD;
+		tio.c_cflag &= ~(CSTOPB | PARENB | CRTSCTS);
+		tcsetattr(fd, TCSANOW, &tio);
+		if (bRequest)
+		{
+			unsigned char aucReq [] = { TELEM_REQ_HELLO, TELEM_REQ_COUNTERS };
+
+			if (write(fd, aucReq, sizeof aucReq) != sizeof aucReq)
+				perror("request");
+		}
+	}
+
+	for (;;)
+	{
+		unsigned char aucIn [256];
+		ssize_t n = read(fd, aucIn, sizeof aucIn);
+
+		if (n <= 0)
+			break;
+		for (ssize_t i = 0; i < n; ++i)
+		{
+			unsigned char ucByte = aucIn[i];
+
+			if (ucByte == TELEM_FLAG)
+			{
+				// anything before the first flag is a partial frame
+				if (bSync && iAt)
+				{
+					++_ulFrames;
+					if (bEsc || bLong || !Decode(aucFrame, iAt))
+						++_ulBad;
+				}
+				bSync = 1;
+				iAt = 0;
+				bEsc = 0;
+				bLong = 0;
+				continue;
+			}
+			if (ucByte == TELEM_ESC)
+			{
+				bEsc = 1;
+				continue;
+			}
+			if (bEsc)
+			{
+				ucByte ^= TELEM_XOR;
+				bEsc = 0;
+			}
+			if (iAt < (int)sizeof aucFrame)
+				aucFrame[iAt++] = ucByte;
+			else
+				bLong = 1;
+		}
+	}
+
+	fprintf(stderr, "frames=%lu bad=%lu dropped=%lu\n", _ulFrames, _ulBad, _ulDropped);
+	return 0;
+}